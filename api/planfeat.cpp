@@ -0,0 +1,145 @@
+/********************************************************/
+/* C interface of the libplanfeat library.              */
+/********************************************************/
+
+#include "planfeat.h"
+#include "../stages/classifier.h"
+#include <string>
+#include <vector>
+#include <exception>
+using namespace std;
+
+struct pf_domain {
+	Classifier* classifier;
+};
+
+struct pf_problem {
+	vector<ObjectClassification> objects;	// Only classified objects
+	vector<int> stages;
+	vector<int> addStages;
+	vector<int> goalAchieved;
+};
+
+// Last error of each thread
+static thread_local string lastError;
+
+// Keeps only the classified objects and builds the integer arrays
+static pf_problem* buildProblem(vector<ObjectClassification>& objects)
+{
+	pf_problem* problem = new pf_problem();
+	for (ObjectClassification& oc : objects) {
+		if (oc.classified) {
+			problem->stages.push_back(oc.stage);
+			problem->addStages.push_back(oc.addStage);
+			problem->goalAchieved.push_back(oc.goalAchieved);
+			problem->objects.push_back(std::move(oc));
+		}
+	}
+	return problem;
+}
+
+pf_domain* pf_load_domain(const char* domain_file, const char* cache_dir)
+{
+	try {
+		pf_domain* domain = new pf_domain();
+		try {
+			domain->classifier = new Classifier((char*)domain_file, cache_dir);
+		}
+		catch (...) {
+			delete domain;
+			throw;
+		}
+		return domain;
+	}
+	catch (exception& e) {
+		lastError = e.what();
+		return nullptr;
+	}
+}
+
+void pf_free_domain(pf_domain* domain)
+{
+	if (domain == nullptr) return;
+	delete domain->classifier;
+	delete domain;
+}
+
+pf_problem* pf_load_problem(pf_domain* domain, const char* problem_file)
+{
+	try {
+		vector<ObjectClassification> objects;
+		domain->classifier->classify((char*)problem_file, objects);
+		return buildProblem(objects);
+	}
+	catch (exception& e) {
+		lastError = e.what();
+		return nullptr;
+	}
+}
+
+pf_problem* pf_load_problem_buffer(pf_domain* domain, const char* buffer, size_t length)
+{
+	try {
+		vector<ObjectClassification> objects;
+		domain->classifier->classify("<buffer>", buffer, length, objects);
+		return buildProblem(objects);
+	}
+	catch (exception& e) {
+		lastError = e.what();
+		return nullptr;
+	}
+}
+
+void pf_free_problem(pf_problem* problem)
+{
+	delete problem;
+}
+
+int pf_num_objects(const pf_problem* problem)
+{
+	return (int)problem->objects.size();
+}
+
+const char* pf_object_name(const pf_problem* problem, int object)
+{
+	return problem->objects[object].name.c_str();
+}
+
+const char* pf_object_type(const pf_problem* problem, int object)
+{
+	return problem->objects[object].type.c_str();
+}
+
+const int* pf_stages(const pf_problem* problem)
+{
+	return problem->stages.data();
+}
+
+const int* pf_add_stages(const pf_problem* problem)
+{
+	return problem->addStages.data();
+}
+
+const int* pf_goal_achieved(const pf_problem* problem)
+{
+	return problem->goalAchieved.data();
+}
+
+const int* pf_goal_stages(const pf_problem* problem, int object, int* count)
+{
+	const vector<int>& v = problem->objects[object].goalStages;
+	*count = (int)v.size();
+	return v.data();
+}
+
+const int* pf_add_goal_stages(const pf_problem* problem, int object, int* count)
+{
+	const vector<int>& v = problem->objects[object].addGoalStages;
+	*count = (int)v.size();
+	return v.data();
+}
+
+const char* pf_last_error(void)
+{
+	return lastError.c_str();
+}
@@ -0,0 +1,65 @@
+#ifndef PLANFEAT_H
+#define PLANFEAT_H
+
+/********************************************************/
+/* C interface of the libplanfeat library. A domain is  */
+/* loaded and analysed once, and then the objects of    */
+/* its problems can be classified without printing or   */
+/* parsing JSON.                                        */
+/********************************************************/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct pf_domain pf_domain;
+typedef struct pf_problem pf_problem;
+
+// Loads and analyses a domain file. cache_dir is the directory of the analysis cache
+// (NULL to disable it). Returns NULL on error (see pf_last_error)
+pf_domain* pf_load_domain(const char* domain_file, const char* cache_dir);
+
+// Frees a domain. Its problems must be freed before
+void pf_free_domain(pf_domain* domain);
+
+// Classifies the objects of a problem file. Returns NULL on error (see pf_last_error)
+pf_problem* pf_load_problem(pf_domain* domain, const char* problem_file);
+
+// Classifies the objects of a problem stored in a memory buffer. Returns NULL on error
+pf_problem* pf_load_problem_buffer(pf_domain* domain, const char* buffer, size_t length);
+
+// Frees a problem
+void pf_free_problem(pf_problem* problem);
+
+// Number of classified objects of the problem (objects whose type has features)
+int pf_num_objects(const pf_problem* problem);
+
+// Name and type of a classified object
+const char* pf_object_name(const pf_problem* problem, int object);
+const char* pf_object_type(const pf_problem* problem, int object);
+
+// Combined stage (CS) of every object, indexed by object number
+const int* pf_stages(const pf_problem* problem);
+
+// Additional stage (AS) of every object, indexed by object number
+const int* pf_add_stages(const pf_problem* problem);
+
+// 1 if the goals of the object are achieved in the initial state, 0 otherwise
+const int* pf_goal_achieved(const pf_problem* problem);
+
+// Combined stages compatible with the goals of an object. count receives the array size
+const int* pf_goal_stages(const pf_problem* problem, int object, int* count);
+
+// Additional stages compatible with the goals of an object. count receives the array size
+const int* pf_add_goal_stages(const pf_problem* problem, int object, int* count);
+
+// Message of the last error in the calling thread
+const char* pf_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !#ifndef PLANFEAT_H
@@ -0,0 +1,155 @@
+/********************************************************/
+/* End-to-end benchmark: runs the whole pipeline (parse,*/
+/* preprocess, task, stages and classification) on the  */
+/* problems of a suite file and reports the median and  */
+/* 95th percentile time of each phase in JSON format.   */
+/* The scanning kernels in use are also reported.       */
+/********************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <string.h>
+#include "../parser/parser.h"
+#include "../parser/scanKernels.h"
+#include "../preprocess/preprocess.h"
+#include "../stages/task.h"
+#include "../stages/stages.h"
+
+using namespace std;
+
+const int NUM_PHASES = 5;
+const char* PHASE_NAMES[NUM_PHASES] = { "parse", "preprocess", "task", "stages", "classify" };
+
+// Benchmark entry of the suite file: <domain_file> <problem_file> [<runs>]
+struct BenchEntry {
+    string domainFileName;
+    string problemFileName;
+    int runs;
+};
+
+// Reads the suite file. Empty lines and lines starting with '#' are ignored
+bool readSuite(char* suiteFileName, int defaultRuns, vector<BenchEntry>& entries) {
+    ifstream suiteFile(suiteFileName);
+    if (!suiteFile.is_open()) return false;
+    string line;
+    while (getline(suiteFile, line)) {
+        istringstream fields(line);
+        BenchEntry entry;
+        if (!(fields >> entry.domainFileName) || entry.domainFileName[0] == '#') continue;
+        if (!(fields >> entry.problemFileName)) continue;
+        if (!(fields >> entry.runs) || entry.runs <= 0) entry.runs = 10;
+        if (defaultRuns > 0) entry.runs = defaultRuns;
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+// Returns the size of a file in bytes
+long fileSize(const string& fileName) {
+    ifstream file(fileName, ios::binary | ios::ate);
+    return file.is_open() ? (long)file.tellg() : 0;
+}
+
+// Returns the elapsed time since the given instant, in milliseconds
+double elapsedMs(chrono::steady_clock::time_point& start) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    double ms = chrono::duration<double, milli>(now - start).count();
+    start = now;
+    return ms;
+}
+
+// Runs the whole pipeline once and stores the time of each phase, in milliseconds
+void runPipeline(BenchEntry& entry, double times[]) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Parser parser;
+    ParsedTask* parsedTask = parser.parseDomain((char*)entry.domainFileName.c_str());
+    parser.parseProblem((char*)entry.problemFileName.c_str());
+    times[0] = elapsedMs(start);
+    Preprocess preprocess;
+    PreprocessedTask* prepTask = preprocess.preprocessTask(parsedTask);
+    times[1] = elapsedMs(start);
+    {
+        Task task(prepTask);
+        times[2] = elapsedMs(start);
+        Stages stages(&task);
+        times[3] = elapsedMs(start);
+        ostringstream out;
+        stages.classify(&task, out);
+        times[4] = elapsedMs(start);
+    }
+    delete prepTask;
+    delete parsedTask;
+}
+
+// Returns the value at the given percentile (0-100) of a sorted list of samples
+double percentile(const vector<double>& sortedSamples, double p) {
+    size_t index = (size_t)(p / 100.0 * (sortedSamples.size() - 1) + 0.5);
+    return sortedSamples[index];
+}
+
+// Writes the median and 95th percentile of the samples as a JSON object
+void phaseToJSON(vector<double>& samples, ostream& out) {
+    sort(samples.begin(), samples.end());
+    out << "{\"medianMs\": " << percentile(samples, 50) << ", \"p95Ms\": " << percentile(samples, 95) << "}";
+}
+
+// Runs the benchmark of a suite entry and writes the results in JSON format
+void runBenchmark(BenchEntry& entry, ostream& out) {
+    double times[NUM_PHASES];
+    runPipeline(entry, times);      // Warm-up run, not measured
+    vector< vector<double> > samples(NUM_PHASES + 1);
+    for (int r = 0; r < entry.runs; r++) {
+        runPipeline(entry, times);
+        double total = 0;
+        for (int i = 0; i < NUM_PHASES; i++) {
+            samples[i].push_back(times[i]);
+            total += times[i];
+        }
+        samples[NUM_PHASES].push_back(total);
+    }
+    long bytes = fileSize(entry.domainFileName) + fileSize(entry.problemFileName);
+    out << "{\"domain\": \"" << entry.domainFileName << "\", \"problem\": \"" << entry.problemFileName
+        << "\", \"bytes\": " << bytes << ", \"runs\": " << entry.runs << ", \"phases\": {";
+    for (int i = 0; i <= NUM_PHASES; i++) {
+        out << "\"" << (i < NUM_PHASES ? PHASE_NAMES[i] : "total") << "\": ";
+        phaseToJSON(samples[i], out);
+        if (i < NUM_PHASES) out << ", ";
+    }
+    double medianTotal = percentile(samples[NUM_PHASES], 50);
+    double medianParse = percentile(samples[0], 50);
+    out << "}, \"problemsPerSec\": " << (medianTotal > 0 ? 1000.0 / medianTotal : 0)
+        << ", \"parseMBps\": " << (medianParse > 0 ? bytes / (medianParse * 1000.0) : 0) << "}";
+}
+
+// Main method
+int main(int argc, char* argv[]) {
+    int defaultRuns = 0;
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "--runs") == 0) {
+        defaultRuns = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    vector<BenchEntry> entries;
+    if (arg + 1 != argc || !readSuite(argv[arg], defaultRuns, entries)) {
+        cout << "Usage: planFeatBench [--runs N] <suite_file>" << endl;
+        cout << "\t(each line of the suite file contains: <domain_file> <problem_file> [<runs>])" << endl;
+        return 1;
+    }
+    try {
+        cout << "{\"scanKernels\": \"" << ScanKernels::implementation() << "\", \"benchmarks\": [" << endl;
+        for (unsigned int i = 0; i < entries.size(); i++) {
+            cout << "  ";
+            runBenchmark(entries[i], cout);
+            cout << (i + 1 < entries.size() ? "," : "") << endl;
+        }
+        cout << "]}" << endl;
+    }
+    catch (ParseError& e) {
+        cerr << e.what() << endl;
+        return e.code;
+    }
+    return 0;
+}
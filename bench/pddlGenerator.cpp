@@ -0,0 +1,253 @@
+/********************************************************/
+/* Synthetic PDDL generator for stress tests. Writes a  */
+/* domain/problem pair whose size grows independently  */
+/* along each axis: types, subtype depth, predicates,   */
+/* arity, operators, objects and initial state.         */
+/********************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+// Generator parameters
+struct GeneratorParams {
+    int numTypes = 2;           // Root types
+    int depth = 1;              // Levels of the subtype chain under each root type
+    int numStates = 3;          // Mutually exclusive reversible features per type
+    int numAddOnly = 1;         // Features added without deleting another one, per type
+    int arity = 1;              // Arity of the state predicates
+    int numActions = 3;         // State-changing operators per type (at least numStates to close the cycle)
+    long numObjects = 1000;     // Total number of objects
+    int initFacts = 1;          // Static facts per object in the initial state
+    double goalRatio = 0.5;     // Fraction of objects with a goal
+    unsigned int seed = 1;
+    string prefix = "synthetic";
+    string toStdout;            // "domain" or "problem" to print only that file to stdout
+};
+
+// Prints the command-line arguments of the generator
+void printUsage() {
+    cout << "Usage: planFeatGen [options]" << endl;
+    cout << "Writes <prefix>-domain.pddl and <prefix>-problem.pddl and prints both file names in a" << endl;
+    cout << "line, ready to be appended to a benchmark suite file. At least one option must be given" << endl;
+    cout << "(for instance, --objects 1000 to use all the defaults)." << endl;
+    cout << "Options:" << endl;
+    cout << "\t--types N\tNumber of root types (default 2)" << endl;
+    cout << "\t--depth N\tDepth of the subtype hierarchy under each root type (default 1)" << endl;
+    cout << "\t--states N\tMutually exclusive reversible features per type (default 3)" << endl;
+    cout << "\t--add-only N\tFeatures added without deleting another one, per type (default 1)" << endl;
+    cout << "\t--arity N\tArity of the state predicates (default 1)" << endl;
+    cout << "\t--actions N\tState-changing operators per type (default 3)" << endl;
+    cout << "\t--objects N\tTotal number of objects (default 1000)" << endl;
+    cout << "\t--init N\tStatic facts per object in the initial state (default 1)" << endl;
+    cout << "\t--goals R\tFraction of objects with a goal (default 0.5)" << endl;
+    cout << "\t--seed N\tRandom seed (default 1)" << endl;
+    cout << "\t--prefix P\tPrefix of the output files (default synthetic)" << endl;
+    cout << "\t--stdout F\tPrints only the domain or the problem (F = domain | problem) to the standard" << endl;
+    cout << "\t\t\toutput, to pipe it into the extractor without temporary files" << endl;
+}
+
+// Parses the command-line arguments. Returns false if they are not valid
+bool parseArgs(int argc, char* argv[], GeneratorParams& params) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) return false;
+        char* value = argv[i + 1];
+        if (strcmp(argv[i], "--types") == 0) params.numTypes = atoi(value);
+        else if (strcmp(argv[i], "--depth") == 0) params.depth = atoi(value);
+        else if (strcmp(argv[i], "--states") == 0) params.numStates = atoi(value);
+        else if (strcmp(argv[i], "--add-only") == 0) params.numAddOnly = atoi(value);
+        else if (strcmp(argv[i], "--arity") == 0) params.arity = atoi(value);
+        else if (strcmp(argv[i], "--actions") == 0) params.numActions = atoi(value);
+        else if (strcmp(argv[i], "--objects") == 0) params.numObjects = atol(value);
+        else if (strcmp(argv[i], "--init") == 0) params.initFacts = atoi(value);
+        else if (strcmp(argv[i], "--goals") == 0) params.goalRatio = atof(value);
+        else if (strcmp(argv[i], "--seed") == 0) params.seed = (unsigned int)atol(value);
+        else if (strcmp(argv[i], "--prefix") == 0) params.prefix = value;
+        else if (strcmp(argv[i], "--stdout") == 0) params.toStdout = value;
+        else return false;
+    }
+    return params.numTypes > 0 && params.depth >= 0 && params.numStates > 0 && params.numAddOnly >= 0
+        && params.arity > 0 && params.numActions > 0 && params.numObjects >= params.numTypes
+        && params.initFacts >= 0 && (params.toStdout.empty() || params.toStdout == "domain"
+        || params.toStdout == "problem");
+}
+
+// Name of the domain: the prefix without its directory
+string domainName(GeneratorParams& params) {
+    size_t slash = params.prefix.find_last_of('/');
+    return slash == string::npos ? params.prefix : params.prefix.substr(slash + 1);
+}
+
+// Name of the type at the given level of the hierarchy of a root type
+string typeName(int root, int level) {
+    return level == 0 ? "t" + to_string(root) : "t" + to_string(root) + "-" + to_string(level);
+}
+
+// Root type of the extra arguments of the predicates of a root type
+int nextRoot(int root, GeneratorParams& params) {
+    return (root + 1) % params.numTypes;
+}
+
+// Name of the object number index of a root type
+string objectName(int root, long index) {
+    return "o" + to_string(root) + "-" + to_string(index);
+}
+
+// Target state of the state-changing operator number k. The first numStates operators
+// form a cycle (reversible features); the rest jump further along the cycle
+int targetState(int k, GeneratorParams& params) {
+    int step = 1 + (k / params.numStates) % max(1, params.numStates - 1);
+    return (k % params.numStates + step) % params.numStates;
+}
+
+// Writes the parameters of a state predicate or operator: ?x of the root type and the
+// extra arguments of the next root type
+void writeStateParameters(ostream& out, int root, GeneratorParams& params) {
+    out << "?x - " << typeName(root, 0);
+    for (int a = 1; a < params.arity; a++) out << " ?a" << a << " - " << typeName(nextRoot(root, params), 0);
+}
+
+// Writes a state literal with variable arguments
+void writeStateLiteral(ostream& out, int root, int state, GeneratorParams& params) {
+    out << "(s" << root << "-" << state << " ?x";
+    for (int a = 1; a < params.arity; a++) out << " ?a" << a;
+    out << ")";
+}
+
+// Writes the domain file
+void writeDomain(ostream& out, GeneratorParams& params) {
+    out << "(define (domain " << domainName(params) << ")" << endl;
+    out << "  (:requirements :strips :typing)" << endl;
+    out << "  (:types";
+    for (int r = 0; r < params.numTypes; r++) {
+        for (int l = 1; l <= params.depth; l++) out << " " << typeName(r, l) << " - " << typeName(r, l - 1);
+        if (params.depth == 0) out << " " << typeName(r, 0);
+    }
+    out << ")" << endl;
+    out << "  (:predicates" << endl;
+    for (int r = 0; r < params.numTypes; r++) {
+        string next = typeName(nextRoot(r, params), 0);
+        for (int s = 0; s < params.numStates; s++) {
+            out << "    (s" << r << "-" << s << " ";
+            writeStateParameters(out, r, params);
+            out << ")" << endl;
+        }
+        for (int m = 0; m < params.numAddOnly; m++)
+            out << "    (add" << r << "-" << m << " ?x - " << typeName(r, 0) << " ?y - " << next << ")" << endl;
+        out << "    (rel" << r << " ?x - " << typeName(r, 0) << " ?y - " << next << ")" << endl;
+    }
+    out << "  )" << endl;
+    for (int r = 0; r < params.numTypes; r++) {
+        for (int k = 0; k < params.numActions; k++) {
+            int from = k % params.numStates, to = targetState(k, params);
+            out << "  (:action change" << r << "-" << k << endl;
+            out << "    :parameters (";
+            writeStateParameters(out, r, params);
+            out << ")" << endl << "    :precondition ";
+            writeStateLiteral(out, r, from, params);
+            out << endl << "    :effect (and (not ";
+            writeStateLiteral(out, r, from, params);
+            out << ") ";
+            writeStateLiteral(out, r, to, params);
+            out << "))" << endl;
+        }
+        string next = typeName(nextRoot(r, params), 0);
+        for (int m = 0; m < params.numAddOnly; m++) {
+            out << "  (:action collect" << r << "-" << m << endl;
+            out << "    :parameters (?x - " << typeName(r, 0) << " ?y - " << next << ")" << endl;
+            out << "    :precondition (rel" << r << " ?x ?y)" << endl;
+            out << "    :effect (add" << r << "-" << m << " ?x ?y))" << endl;
+            out << "  (:action shift" << r << "-" << m << endl;
+            out << "    :parameters (?x - " << typeName(r, 0) << " ?y - " << next << ")" << endl;
+            out << "    :precondition (add" << r << "-" << m << " ?x ?y)" << endl;
+            out << "    :effect (and (not (add" << r << "-" << m << " ?x ?y))";
+            if (params.numAddOnly > 1) out << " (add" << r << "-" << (m + 1) % params.numAddOnly << " ?x ?y)";
+            out << "))" << endl;
+        }
+    }
+    out << ")" << endl;
+}
+
+// Writes a state fact of an object with random extra arguments
+void writeStateFact(ostream& out, int root, long obj, int state, vector<long>& numObjects,
+    GeneratorParams& params, mt19937& rnd) {
+    int next = nextRoot(root, params);
+    out << "    (s" << root << "-" << state << " " << objectName(root, obj);
+    for (int a = 1; a < params.arity; a++) out << " " << objectName(next, rnd() % numObjects[next]);
+    out << ")" << endl;
+}
+
+// Writes the problem file. The objects of each root type are spread over all the levels
+// of its subtype hierarchy
+void writeProblem(ostream& out, GeneratorParams& params) {
+    mt19937 rnd(params.seed);
+    vector<long> numObjects(params.numTypes, params.numObjects / params.numTypes);
+    for (long i = 0; i < params.numObjects % params.numTypes; i++) numObjects[i]++;
+    out << "(define (problem " << domainName(params) << "-p) (:domain " << domainName(params) << ")" << endl;
+    out << "  (:objects" << endl;
+    for (int r = 0; r < params.numTypes; r++) {
+        for (int l = 0; l <= params.depth; l++) {
+            bool empty = true;
+            for (long i = l; i < numObjects[r]; i += params.depth + 1) {
+                out << (empty ? "    " : " ") << objectName(r, i);
+                empty = false;
+            }
+            if (!empty) out << " - " << typeName(r, l) << endl;
+        }
+    }
+    out << "  )" << endl << "  (:init" << endl;
+    for (int r = 0; r < params.numTypes; r++) {
+        int next = nextRoot(r, params);
+        for (long i = 0; i < numObjects[r]; i++) {
+            writeStateFact(out, r, i, rnd() % params.numStates, numObjects, params, rnd);
+            for (int f = 0; f < params.initFacts; f++)
+                out << "    (rel" << r << " " << objectName(r, i) << " " << objectName(next, rnd() % numObjects[next]) << ")" << endl;
+        }
+    }
+    out << "  )" << endl << "  (:goal (and" << endl;
+    uniform_real_distribution<double> ratio(0.0, 1.0);
+    for (int r = 0; r < params.numTypes; r++) {
+        int next = nextRoot(r, params);
+        for (long i = 0; i < numObjects[r]; i++) {
+            if (ratio(rnd) >= params.goalRatio) continue;
+            if (params.numAddOnly > 0 && rnd() % 2 == 0)
+                out << "    (add" << r << "-" << rnd() % params.numAddOnly << " " << objectName(r, i) << " "
+                    << objectName(next, rnd() % numObjects[next]) << ")" << endl;
+            else
+                writeStateFact(out, r, i, rnd() % params.numStates, numObjects, params, rnd);
+        }
+    }
+    out << "  ))" << endl << ")" << endl;
+}
+
+// Main method
+int main(int argc, char* argv[]) {
+    GeneratorParams params;
+    if (argc < 2 || !parseArgs(argc, argv, params)) {
+        printUsage();
+        return 1;
+    }
+    if (params.toStdout == "domain") writeDomain(cout, params);
+    else if (params.toStdout == "problem") writeProblem(cout, params);
+    else {
+        string domainFileName = params.prefix + "-domain.pddl";
+        string problemFileName = params.prefix + "-problem.pddl";
+        ofstream domainFile(domainFileName), problemFile(problemFileName);
+        writeDomain(domainFile, params);
+        writeProblem(problemFile, params);
+        domainFile.close();
+        problemFile.close();
+        if (!domainFile || !problemFile) {
+            cerr << "Unable to write " << (!domainFile ? domainFileName : problemFileName) << endl;
+            return 1;
+        }
+        cout << domainFileName << " " << problemFileName << endl;
+    }
+    return 0;
+}
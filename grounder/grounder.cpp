@@ -63,6 +63,7 @@ ProgrammedValue::ProgrammedValue(unsigned int index, unsigned int varIndex, unsi
 GroundedTask* Grounder::groundTask(PreprocessedTask *prepTask, bool keepStaticData) {
     currentLevel = 0;
     this->prepTask = prepTask;
+    prepTask->task->atomsToFacts();     // The grounder works with Fact objects
     gTask = new GroundedTask(prepTask->task);
     initTypesMatrix();
     initOperators();
@@ -0,0 +1,118 @@
+/********************************************************/
+/* Streaming decompressor of the compressed inputs of   */
+/* the syntactic analyzer: gzip (zlib) and, if compiled */
+/* with PLANFEAT_ZSTD, zstd. The compressed data is     */
+/* read from a file descriptor in fixed-size chunks.    */
+/********************************************************/
+
+#include "decompressor.h"
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+using namespace std;
+
+// Size of the chunks of compressed data read from the descriptor
+const size_t compressedChunkSize = 65536;
+
+// Returns the format of a compressed input from its first bytes (magic numbers)
+CompressionFormat Decompressor::detect(const char* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (length >= 2 && bytes[0] == 0x1F && bytes[1] == 0x8B) return CF_GZIP;
+    if (length >= 4 && bytes[0] == 0x28 && bytes[1] == 0xB5 && bytes[2] == 0x2F && bytes[3] == 0xFD) return CF_ZSTD;
+    return CF_NONE;
+}
+
+// Checks if the given format can be decompressed (zstd needs the PLANFEAT_ZSTD build)
+bool Decompressor::isSupported(CompressionFormat format) {
+#ifdef PLANFEAT_ZSTD
+    return true;
+#else
+    return format != CF_ZSTD;
+#endif
+}
+
+// Creates a decompressor. The given data are the first bytes of the input, already read
+// from the descriptor to detect the format
+Decompressor::Decompressor(CompressionFormat format, const char* data, size_t length) {
+    this->format = format;
+    input.resize(length > compressedChunkSize ? length : compressedChunkSize);
+    memcpy(input.data(), data, length);
+    inputPosition = 0;
+    inputLength = length;
+    inputEnded = false;
+    frameEnded = false;
+    memset(&gzipStream, 0, sizeof(z_stream));
+    if (format == CF_GZIP) inflateInit2(&gzipStream, 15 + 16);     // gzip header
+#ifdef PLANFEAT_ZSTD
+    zstdStream = format == CF_ZSTD ? ZSTD_createDStream() : nullptr;
+    if (zstdStream != nullptr) ZSTD_initDStream(zstdStream);
+#endif
+}
+
+// Disposes the decompressor
+Decompressor::~Decompressor() {
+    if (format == CF_GZIP) inflateEnd(&gzipStream);
+#ifdef PLANFEAT_ZSTD
+    if (zstdStream != nullptr) ZSTD_freeDStream(zstdStream);
+#endif
+}
+
+// Reads the next chunk of compressed data. Returns false at the end of the descriptor
+bool Decompressor::readInput(int fd) {
+    ssize_t n;
+    do {
+        n = ::read(fd, input.data(), input.size());
+    } while (n == -1 && errno == EINTR);
+    inputPosition = 0;
+    inputLength = n > 0 ? (size_t)n : 0;
+    if (n <= 0) inputEnded = true;
+    return n > 0;
+}
+
+// Decompresses the available input into the output buffer. Returns the number of bytes
+// written, or -1 if the data is corrupted
+int Decompressor::decompress(char* output, int capacity) {
+    if (format == CF_GZIP) {
+        if (frameEnded) {       // Another member follows (concatenated gzip files)
+            inflateReset(&gzipStream);
+            frameEnded = false;
+        }
+        gzipStream.next_in = (Bytef*)input.data() + inputPosition;
+        gzipStream.avail_in = (uInt)(inputLength - inputPosition);
+        gzipStream.next_out = (Bytef*)output;
+        gzipStream.avail_out = (uInt)capacity;
+        int result = inflate(&gzipStream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) frameEnded = true;
+        else if (result != Z_OK && result != Z_BUF_ERROR) return -1;
+        inputPosition = inputLength - gzipStream.avail_in;
+        return capacity - (int)gzipStream.avail_out;
+    }
+#ifdef PLANFEAT_ZSTD
+    ZSTD_inBuffer in = { input.data(), inputLength, inputPosition };
+    ZSTD_outBuffer out = { output, (size_t)capacity, 0 };
+    size_t result = ZSTD_decompressStream(zstdStream, &out, &in);
+    if (ZSTD_isError(result)) return -1;
+    frameEnded = result == 0;
+    inputPosition = in.pos;
+    return (int)out.pos;
+#else
+    return -1;
+#endif
+}
+
+// Reads decompressed data from the descriptor into the output buffer. Returns the number
+// of bytes written (0 at the end of the input), or -1 if the data is corrupted or truncated
+int Decompressor::read(int fd, char* output, int capacity) {
+    int produced = 0;
+    while (produced == 0) {
+        if (inputPosition == inputLength && !inputEnded) {
+            readInput(fd);
+        }
+        if (inputPosition == inputLength && inputEnded) {
+            return frameEnded ? 0 : -1;
+        }
+        produced = decompress(output, capacity);
+        if (produced < 0) return -1;
+    }
+    return produced;
+}
@@ -0,0 +1,42 @@
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+/********************************************************/
+/* Streaming decompressor of the compressed inputs of   */
+/* the syntactic analyzer: gzip (zlib) and, if compiled */
+/* with PLANFEAT_ZSTD, zstd. The compressed data is     */
+/* read from a file descriptor in fixed-size chunks.    */
+/********************************************************/
+
+#include <vector>
+#include <zlib.h>
+#ifdef PLANFEAT_ZSTD
+#include <zstd.h>
+#endif
+
+enum CompressionFormat { CF_NONE = 0, CF_GZIP = 1, CF_ZSTD = 2 };
+
+class Decompressor {
+private:
+    CompressionFormat format;
+    std::vector<char> input;    // Compressed data read from the descriptor
+    size_t inputPosition;       // First byte of the compressed data not consumed yet
+    size_t inputLength;
+    bool inputEnded;            // End of the descriptor reached
+    bool frameEnded;            // The last gzip member or zstd frame is complete
+    z_stream gzipStream;
+#ifdef PLANFEAT_ZSTD
+    ZSTD_DStream* zstdStream;
+#endif
+    bool readInput(int fd);
+    int decompress(char* output, int capacity);
+
+public:
+    static CompressionFormat detect(const char* data, size_t length);
+    static bool isSupported(CompressionFormat format);
+    Decompressor(CompressionFormat format, const char* data, size_t length);
+    ~Decompressor();
+    int read(int fd, char* output, int capacity);
+};
+
+#endif
@@ -142,7 +142,7 @@ NumericExpression::NumericExpression(unsigned int fncIndex, const vector<Term>&
         function.params.push_back(fncParams[i]);
 }
 
-NumericExpression::NumericExpression(Symbol s, const vector<NumericExpression>& operands, SyntaxAnalyzer* syn) {
+NumericExpression::NumericExpression(Symbol s, vector<NumericExpression> operands, SyntaxAnalyzer* syn) {
     switch (s) {
     case Symbol::MINUS:
         if (operands.size() == 1) type = NET_NEGATION;
@@ -163,8 +163,7 @@ NumericExpression::NumericExpression(Symbol s, const vector<NumericExpression>&
         break;
     default: syn->notifyError("Invalid expression type");
     }
-    for (unsigned int i = 0; i < operands.size(); i++)
-        this->operands.push_back(operands[i]);
+    this->operands = std::move(operands);
 }
 
 string NumericExpression::toString(const vector<Variable>& parameters, const vector<Variable>& controlVars, 
@@ -193,9 +192,9 @@ string NumericExpression::toString(const vector<Variable>& parameters, const vec
 /* CLASS: Duration (duration constraint)                */
 /********************************************************/
 
-Duration::Duration(Symbol s, const NumericExpression& exp) {
+Duration::Duration(Symbol s, NumericExpression exp) {
     time = TimeSpecifier::NONE;
-    this->exp = exp;
+    this->exp = std::move(exp);
     if (s == Symbol::EQUAL) comp = Comparator::CMP_EQ;
     else if (s == Symbol::LESS_EQ) comp = Comparator::CMP_LESS_EQ;
     else comp = Comparator::CMP_GREATER_EQ;
@@ -220,7 +219,7 @@ string Duration::toString(const vector<Variable>& parameters, const vector<Varia
 
 void GoalDescription::setLiteral(Literal literal) {
     type = GoalDescriptionType::GD_LITERAL;
-    this->literal = literal;
+    this->literal = std::move(literal);
 }
 
 string GoalDescription::toString(const vector<Variable>& opParameters, const vector<Variable>& controlVars,
@@ -645,6 +644,39 @@ string Fact::toStringShort(const vector<Function>& functions, const vector<Objec
     return s + ")";
 }
 
+/********************************************************/
+/* CLASS: AtomStore (initial atoms by columns)          */
+/********************************************************/
+
+// Returns an atom as a fact (trueValue is the index of the constant true)
+Fact AtomStore::toFact(unsigned int atom, unsigned int trueValue) const {
+    Fact f;
+    f.valueIsNumeric = false;
+    f.function = functions[atom];
+    f.value = trueValue;
+    f.numericValue = 0;
+    f.time = 0;
+    const unsigned int* args = getArguments(atom);
+    f.parameters.assign(args, args + numArguments(atom));
+    return f;
+}
+
+// Adds the atoms of another store at the end of this one
+void AtomStore::append(const AtomStore& other) {
+    unsigned int offset = (unsigned int)arguments.size();
+    functions.insert(functions.end(), other.functions.begin(), other.functions.end());
+    arguments.insert(arguments.end(), other.arguments.begin(), other.arguments.end());
+    for (unsigned int i = 1; i < other.firstArgument.size(); i++)
+        firstArgument.push_back(other.firstArgument[i] + offset);
+}
+
+// Removes all the atoms
+void AtomStore::clear() {
+    functions.clear();
+    firstArgument.resize(1);
+    arguments.clear();
+}
+
 /********************************************************/
 /* CLASS: Metric (PDDL metric expression)               */
 /********************************************************/
@@ -797,20 +829,29 @@ void ParsedTask::setRequirement(string name) {
     requirements.push_back(name);
 }
 
+// Returns the element of an index by symbol, or MAX_UNSIGNED_INT if the symbol is not in it
+unsigned int ParsedTask::findBySymbol(const vector<unsigned int>& index, unsigned int symbol) {
+    return symbol < index.size() ? index[symbol] : MAX_UNSIGNED_INT;
+}
+
+// Stores an element in an index by symbol, interning its name
+void ParsedTask::setBySymbol(vector<unsigned int>& index, const string& name, unsigned int value) {
+    unsigned int symbol = symbols.intern(name);
+    if (symbol >= index.size()) index.resize(symbols.size(), MAX_UNSIGNED_INT);
+    index[symbol] = value;
+}
+
 // Returns the index of a type through its name
 unsigned int ParsedTask::getTypeIndex(string const& name) {
-    unordered_map<string, unsigned int>::const_iterator index = typesByName.find(name);
-    if (index == typesByName.end()) {   // Type not found
-        if (name.compare("#object") == 0) {
-            unsigned int i = (unsigned int)types.size();
-            Type t(i, name);
-            types.push_back(t);
-            typesByName[name] = i;
-            return i;
-        }
-        else return MAX_UNSIGNED_INT;
+    unsigned int index = findBySymbol(typesBySymbol, symbols.find(name));
+    if (index == MAX_UNSIGNED_INT && name.compare("#object") == 0) {   // Type not found
+        unsigned int i = (unsigned int)types.size();
+        Type t(i, name);
+        types.push_back(t);
+        setBySymbol(typesBySymbol, name, i);
+        return i;
     }
-    return index->second;
+    return index;
 }
 
 // Stores a PDDL type and returns its index
@@ -824,7 +865,7 @@ unsigned int ParsedTask::addType(string name, vector<unsigned int>& parentTypes,
         index = (unsigned int)types.size();
         Type newType(index, name);
         types.push_back(newType);
-        typesByName[name] = index;
+        setBySymbol(typesBySymbol, name, index);
         t = &(types.back());
     }
     for (unsigned int i = 0; i < parentTypes.size(); i++) {
@@ -835,9 +876,7 @@ unsigned int ParsedTask::addType(string name, vector<unsigned int>& parentTypes,
 
 // Returns the index of an object through its name
 unsigned int ParsedTask::getObjectIndex(string const& name) {
-    unordered_map<string, unsigned int>::const_iterator index = objectsByName.find(name);
-    if (index == objectsByName.end()) return MAX_UNSIGNED_INT;
-    else return index->second;
+    return findBySymbol(objectsBySymbol, symbols.find(name));
 }
 
 // Stores a PDDL constant and returns its index
@@ -849,7 +888,7 @@ unsigned int ParsedTask::addConstant(string name, vector<unsigned int>& types, S
     for (unsigned int i = 0; i < types.size(); i++)
         obj.types.push_back(types[i]);
     objects.push_back(obj);
-    objectsByName[name] = index;
+    setBySymbol(objectsBySymbol, name, index);
     return index;
 }
 
@@ -864,7 +903,7 @@ unsigned int ParsedTask::addObject(string name, vector<unsigned int>& types, Syn
         index = (unsigned int)objects.size();
         Object newObj(index, name, false);
         objects.push_back(newObj);
-        objectsByName[name] = index;
+        setBySymbol(objectsBySymbol, name, index);
         obj = &(objects.back());
     }
     for (unsigned int i = 0; i < types.size(); i++) {
@@ -875,9 +914,7 @@ unsigned int ParsedTask::addObject(string name, vector<unsigned int>& types, Syn
 
 // Returns the index of a function through its name
 unsigned int ParsedTask::getFunctionIndex(string const& name) {
-    unordered_map<string, unsigned int>::const_iterator index = functionsByName.find(name);
-    if (index == functionsByName.end()) return MAX_UNSIGNED_INT;
-    else return index->second;
+    return findBySymbol(functionsBySymbol, symbols.find(name));
 }
 
 // Returns the index of a preference through its name
@@ -895,7 +932,7 @@ unsigned int ParsedTask::addPredicate(Function fnc, SyntaxAnalyzer* syn) {
     fnc.index = index;
     fnc.valueTypes.push_back(BOOLEAN_TYPE);
     functions.push_back(fnc);
-    functionsByName[fnc.name] = index;
+    setBySymbol(functionsBySymbol, fnc.name, index);
     return index;
 }
 
@@ -907,52 +944,49 @@ unsigned int ParsedTask::addFunction(Function fnc, const vector<unsigned int>& v
     fnc.index = index;
     fnc.setValueTypes(valueTypes);
     functions.push_back(fnc);
-    functionsByName[fnc.name] = index;
+    setBySymbol(functionsBySymbol, fnc.name, index);
     return index;
 }
 
-// Stores a durative action and returns its index
+// Stores a durative action and returns its index. The duration, condition and effect
+// trees are moved into the action
 unsigned int ParsedTask::addAction(string name, const vector<Variable>& parameters, const vector<Variable>& controlVars,
-    const vector<Duration>& duration, const DurativeCondition& condition,
-    const DurativeEffect& effect, SyntaxAnalyzer* syn) {
+    vector<Duration> duration, DurativeCondition condition, DurativeEffect effect, SyntaxAnalyzer* syn) {
     for (unsigned int i = 0; i < durativeActions.size(); i++)
         if (durativeActions[i].name.compare(name) == 0)
             syn->notifyError("Action '" + name + "' redefined");
     for (unsigned int i = 0; i < actions.size(); i++)
         if (actions[i].name.compare(name) == 0)
             syn->notifyError("Action '" + name + "' redefined");
-    DurativeAction a;
-    a.index = (unsigned int)durativeActions.size();
+    durativeActions.emplace_back();
+    DurativeAction& a = durativeActions.back();
+    a.index = (unsigned int)durativeActions.size() - 1;
     a.name = name;
-    for (unsigned int i = 0; i < parameters.size(); i++)
-        a.parameters.push_back(parameters[i]);
-    for (unsigned int i = 0; i < controlVars.size(); i++)
-        a.controlVars.push_back(controlVars[i]);
-    for (unsigned int i = 0; i < duration.size(); i++)
-        a.duration.push_back(duration[i]);
-    a.condition = condition;
-    a.effect = effect;
-    durativeActions.push_back(a);
+    a.parameters = parameters;
+    a.controlVars = controlVars;
+    a.duration = std::move(duration);
+    a.condition = std::move(condition);
+    a.effect = std::move(effect);
     return a.index;
 }
 
-// Stores an action and returns its index
+// Stores an action and returns its index. The precondition and effect trees are moved
+// into the action
 unsigned int ParsedTask::addAction(std::string name, const vector<Variable>& parameters,
-    const Precondition& precondition, const Effect& effect, SyntaxAnalyzer* syn) {
+    Precondition precondition, Effect effect, SyntaxAnalyzer* syn) {
     for (unsigned int i = 0; i < durativeActions.size(); i++)
         if (durativeActions[i].name.compare(name) == 0)
             syn->notifyError("Action '" + name + "' redefined");
     for (unsigned int i = 0; i < actions.size(); i++)
         if (actions[i].name.compare(name) == 0)
             syn->notifyError("Action '" + name + "' redefined");
-    Action a;
-    a.index = (int)actions.size();
+    actions.emplace_back();
+    Action& a = actions.back();
+    a.index = (int)actions.size() - 1;
     a.name = name;
-    for (unsigned int i = 0; i < parameters.size(); i++)
-        a.parameters.push_back(parameters[i]);
-    a.precondition = precondition;
-    a.effect = effect;
-    actions.push_back(a);
+    a.parameters = parameters;
+    a.precondition = std::move(precondition);
+    a.effect = std::move(effect);
     return a.index;
 }
 
@@ -994,6 +1028,14 @@ bool ParsedTask::isBooleanFunction(unsigned int fncIndex) {
     return f.valueTypes[0] == BOOLEAN_TYPE;
 }
 
+// Moves the atoms of the columnar store to the list of initial facts, for the modules
+// that work with Fact objects (grounder)
+void ParsedTask::atomsToFacts() {
+    for (unsigned int i = 0; i < initAtoms.size(); i++)
+        init.push_back(initAtoms.toFact(i, CONSTANT_TRUE));
+    initAtoms.clear();
+}
+
 // Returns a description of this planning task
 string ParsedTask::toString() {
     string res = "Domain: " + domainName;
@@ -1014,6 +1056,8 @@ string ParsedTask::toString() {
     for (unsigned int i = 0; i < actions.size(); i++)
         res += "\n" + actions[i].toString(functions, objects, types);
     res += "\nInit:";
+    for (unsigned int i = 0; i < initAtoms.size(); i++)
+        res += "\n* " + initAtoms.toFact(i, CONSTANT_TRUE).toString(functions, objects);
     for (unsigned int i = 0; i < init.size(); i++)
         res += "\n* " + init[i].toString(functions, objects);
     vector<Variable> parameters;
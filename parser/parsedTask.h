@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 #include "syntaxAnalyzer.h"
 
 /********************************************************/
@@ -99,7 +100,7 @@ public:
     NumericExpression();
     NumericExpression(float value);
     NumericExpression(unsigned int fncIndex, const std::vector<Term>& fncParams);
-    NumericExpression(Symbol s, const std::vector<NumericExpression>& operands, SyntaxAnalyzer* syn);
+    NumericExpression(Symbol s, std::vector<NumericExpression> operands, SyntaxAnalyzer* syn);
     std::string toString(const std::vector<Variable>& parameters, const std::vector<Variable>& controlVars, 
         const std::vector<Function>& functions, const std::vector<Object>& objects);
 };
@@ -116,7 +117,7 @@ public:
     TimeSpecifier time;
     Comparator comp;
     NumericExpression exp;
-    Duration(Symbol s, const NumericExpression& exp);
+    Duration(Symbol s, NumericExpression exp);
     std::string toString(const std::vector<Variable>& parameters, const std::vector<Variable>& controlVars,
         const std::vector<Function>& functions, const std::vector<Object>& objects);
 };
@@ -309,6 +310,29 @@ public:
     std::string toStringShort(const std::vector<Function>& functions, const std::vector<Object>& objects);
 };
 
+// Plain ground atoms of the initial state (predicates without time), stored by columns:
+// the function of each atom and the position of its arguments in a single vector of
+// object indexes. The other initial facts are stored in ParsedTask::init
+class AtomStore {
+public:
+    std::vector<unsigned int> functions;
+    std::vector<unsigned int> firstArgument;    // One more entry at the end
+    std::vector<unsigned int> arguments;
+    AtomStore() { firstArgument.push_back(0); }
+    inline unsigned int size() const { return (unsigned int)functions.size(); }
+    inline unsigned int numArguments(unsigned int atom) const { return firstArgument[atom + 1] - firstArgument[atom]; }
+    inline const unsigned int* getArguments(unsigned int atom) const { return arguments.data() + firstArgument[atom]; }
+    inline void addArgument(unsigned int object) { arguments.push_back(object); }
+    // Closes the atom whose arguments have just been added
+    inline void endAtom(unsigned int function) {
+        functions.push_back(function);
+        firstArgument.push_back((unsigned int)arguments.size());
+    }
+    Fact toFact(unsigned int atom, unsigned int trueValue) const;
+    void append(const AtomStore& other);
+    void clear();
+};
+
 enum MetricType { MT_MINIMIZE = 0, MT_MAXIMIZE = 1, MT_NONE = 2 };
 
 enum MetricExpressionType {
@@ -359,13 +383,17 @@ public:
 
 class ParsedTask {
 private:
-    std::unordered_map<std::string, unsigned int> typesByName;
-    std::unordered_map<std::string, unsigned int> objectsByName;
-    std::unordered_map<std::string, unsigned int> functionsByName;
+    std::vector<unsigned int> typesBySymbol;        // Indexed by the identifier of the name in the symbol table
+    std::vector<unsigned int> objectsBySymbol;
+    std::vector<unsigned int> functionsBySymbol;
     std::unordered_map<std::string, unsigned int> preferencesByName;
     std::vector<Constraint> preferences;
 
+    unsigned int findBySymbol(const std::vector<unsigned int>& index, unsigned int symbol);
+    void setBySymbol(std::vector<unsigned int>& index, const std::string& name, unsigned int value);
+
 public:
+    SymbolTable symbols;                // Interning table of the names read by the lexer
     unsigned int BOOLEAN_TYPE;
     unsigned int NUMBER_TYPE;
     unsigned int INTEGER_TYPE;
@@ -379,7 +407,8 @@ public:
     std::vector<Function> functions;
     std::vector<DurativeAction> durativeActions;
     std::vector<Action> actions;
-    std::vector<Fact> init;
+    AtomStore initAtoms;                // Plain atoms of the initial state
+    std::vector<Fact> init;             // Initial fluents and timed initial literals
     std::vector<Constraint> constraints;
     std::vector<DerivedPredicate> derivedPredicates;
     Precondition goal;
@@ -391,11 +420,14 @@ public:
     void setProblemName(std::string name);
     void setRequirement(std::string name);
     unsigned int getTypeIndex(std::string const& name);
+    inline unsigned int getTypeIndex(unsigned int symbol) { return findBySymbol(typesBySymbol, symbol); }
     unsigned int addType(std::string name, std::vector<unsigned int>& parentTypes, SyntaxAnalyzer* syn);
     unsigned int getObjectIndex(std::string const& name);
+    inline unsigned int getObjectIndex(unsigned int symbol) { return findBySymbol(objectsBySymbol, symbol); }
     unsigned int addConstant(std::string name, std::vector<unsigned int>& types, SyntaxAnalyzer* syn);
     unsigned int addObject(std::string name, std::vector<unsigned int>& types, SyntaxAnalyzer* syn);
     unsigned int getFunctionIndex(std::string const& name);
+    inline unsigned int getFunctionIndex(unsigned int symbol) { return findBySymbol(functionsBySymbol, symbol); }
     unsigned int addPredicate(Function fnc, SyntaxAnalyzer* syn);
     unsigned int addFunction(Function fnc, const std::vector<unsigned int>& valueTypes, SyntaxAnalyzer* syn);
     unsigned int addPreference(std::string name, const GoalDescription& goal, SyntaxAnalyzer* syn);
@@ -406,11 +438,11 @@ public:
     bool compatibleTypes(const std::vector<unsigned int>& types, const std::vector<unsigned int>& validTypes);
     bool compatibleTypes(unsigned int t1, unsigned int t2);
     bool compatibleTypes(Type* t, Variable* v);
+    void atomsToFacts();
     unsigned int addAction(std::string name, const std::vector<Variable>& parameters, const std::vector<Variable>& controlVars,
-        const std::vector<Duration>& duration, const DurativeCondition& condition,
-        const DurativeEffect& effect, SyntaxAnalyzer* syn);
+        std::vector<Duration> duration, DurativeCondition condition, DurativeEffect effect, SyntaxAnalyzer* syn);
     unsigned int addAction(std::string name, const std::vector<Variable>& parameters,
-        const Precondition& precondition, const Effect& effect, SyntaxAnalyzer* syn);
+        Precondition precondition, Effect effect, SyntaxAnalyzer* syn);
     std::string toString();
     static std::string comparatorToString(Comparator cmp);
     static std::string assignmentToString(Assignment a);
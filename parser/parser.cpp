@@ -7,10 +7,20 @@
 /********************************************************/
 
 #include "parser.h"
+#include "../utils/profiler.h"
 #include "../utils/utils.h"
+#include "../utils/workStealingPool.h"
 #include <iostream>
+#include <exception>
 using namespace std;
 
+// Minimum size, in bytes, of the chunks of the :init section parsed in parallel. Smaller
+// sections are parsed sequentially
+const int minInitChunkSize = 256 * 1024;
+
+// Maximum number of threads to parse the :init section (0 = all cores)
+unsigned int Parser::maxThreads = 0;
+
 // Creates a new parser
 Parser::Parser() {
     task = nullptr;
@@ -19,15 +29,16 @@ Parser::Parser() {
 
 // Disposes the parser
 Parser::~Parser() {
-
+    if (syn != nullptr) delete syn;   // Only if the parsing was interrupted by an error
 }
 
 // <domain> ::= (define (domain <name>) [<require-def>] [<types-def>]:typing
 //  [<constants-def>] [<predicates-def>] [<functions-def>]:fluents
 //  [<constraints>] <structure-def>*)
 ParsedTask* Parser::parseDomain(char* domainFileName) {
+    ProfileScope profile("parseDomain");
     task = new ParsedTask();
-    syn = new SyntaxAnalyzer(domainFileName);
+    syn = new SyntaxAnalyzer(domainFileName, &task->symbols);
     syn->openPar();
     syn->readSymbol(Symbol::DEFINE);
     syn->openPar();
@@ -55,7 +66,12 @@ ParsedTask* Parser::parseDomain(char* domainFileName) {
         }
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
     }
+    profile.count("tokens", syn->numTokens());
+    profile.count("types", task->types.size());
+    profile.count("functions", task->functions.size());
+    profile.count("actions", task->actions.size() + task->durativeActions.size());
     delete syn;
+    syn = nullptr;
     return task;
 }
 
@@ -67,10 +83,16 @@ ParsedTask* Parser::parseDomain(char* domainFileName) {
 //              [<metric-spec>]:numeric-fluents
 //              [<length-spec>])
 ParsedTask* Parser::parseProblem(char* problemFileName) {
+    syn = new SyntaxAnalyzer(problemFileName, &task->symbols);
+    return parseProblem();
+}
+
+// Parses a problem from the text of the syntactic analyzer
+ParsedTask* Parser::parseProblem() {
+    ProfileScope profile("parseProblem");
     task->metricType = MT_NONE;
     task->serialLength = -1;
     task->parallelLength = -1;
-    syn = new SyntaxAnalyzer(problemFileName);
     syn->openPar();
     syn->readSymbol(Symbol::DEFINE);
     syn->openPar();
@@ -100,10 +122,29 @@ ParsedTask* Parser::parseProblem(char* problemFileName) {
         }
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
     }
+    profile.count("tokens", syn->numTokens());
+    profile.count("objects", task->objects.size());
+    profile.count("facts", task->init.size() + task->initAtoms.size());
     delete syn;
+    syn = nullptr;
     return task;
 }
 
+// Parses a problem file over a previously parsed domain (batch mode, where
+// domainTask is a copy of the parsed domain)
+ParsedTask* Parser::parseProblem(char* problemFileName, ParsedTask* domainTask) {
+    task = domainTask;
+    return parseProblem(problemFileName);
+}
+
+// Parses a problem stored in a memory buffer over a previously parsed domain. The problem
+// name is only used in the error messages
+ParsedTask* Parser::parseProblem(const char* problemName, const char* buffer, size_t length, ParsedTask* domainTask) {
+    task = domainTask;
+    syn = new SyntaxAnalyzer(problemName, buffer, length, &task->symbols);
+    return parseProblem();
+}
+
 // <require-def> ::= (:requirements <require-key>+)
 void Parser::parseRequirements() {
     Token* token = syn->readSymbol(2, Symbol::COLON, Symbol::CLOSE_PAR);
@@ -146,7 +187,7 @@ void Parser::parseParentTypes(std::vector<unsigned int>& types, bool allowNumber
         : syn->readSymbol(3, Symbol::OPEN_PAR, Symbol::NUMBER_TYPE, Symbol::NAME);
     unsigned int index;
     if (syn->isSym(token, Symbol::NAME)) {
-        index = task->getTypeIndex(token->description);
+        index = task->getTypeIndex(token->id);
         if (index == MAX_UNSIGNED_INT) {
             index = task->getTypeIndex("#object");
             if (token->description.compare("object") != 0) {
@@ -165,7 +206,7 @@ void Parser::parseParentTypes(std::vector<unsigned int>& types, bool allowNumber
         do {
             token = syn->readSymbol(2, Symbol::CLOSE_PAR, Symbol::NAME);
             if (syn->isSym(token, Symbol::NAME)) {
-                index = task->getTypeIndex(token->description);
+                index = task->getTypeIndex(token->id);
                 if (index == MAX_UNSIGNED_INT) {
                     index = task->getTypeIndex("#object");
                     if (token->description.compare("object") != 0) {
@@ -205,15 +246,13 @@ void Parser::parseConstants() {
 
 // (:predicates <atomic formula skeleton>+)
 void Parser::parsePredicates() {
-    Token* token;
-    do {
+    Token* token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
+    while (syn->isSym(token, Symbol::OPEN_PAR)) {
+        syn->undoToken();
+        Function const& fnc = parsePredicate();
+        task->addPredicate(fnc, syn);
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
-        if (syn->isSym(token, Symbol::OPEN_PAR)) {
-            syn->undoToken();
-            Function const& fnc = parsePredicate();
-            task->addPredicate(fnc, syn);
-        }
-    } while (!syn->isSym(token, Symbol::CLOSE_PAR));
+    }
 }
 
 // <atomic formula skeleton> ::= (<predicate> <typed list (variable)>)
@@ -295,9 +334,11 @@ void Parser::parseFunctions() {
     vector<Function> functions;
     vector<unsigned int> types;
     Token* token, * aux;
+    bool moreFunctions;
     do {
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
-        if (syn->isSym(token, Symbol::OPEN_PAR)) {
+        moreFunctions = syn->isSym(token, Symbol::OPEN_PAR);
+        if (moreFunctions) {
             do {
                 syn->undoToken();
                 Function fnc = parsePredicate();
@@ -307,14 +348,14 @@ void Parser::parseFunctions() {
             if (syn->isSym(aux, Symbol::MINUS)) parseParentTypes(types, true);
             else {
                 types.push_back(task->NUMBER_TYPE);
-                token->symbol = Symbol::CLOSE_PAR;
+                moreFunctions = false;
             }
             for (unsigned int i = 0; i < functions.size(); i++)
                 task->addFunction(functions[i], types, syn);
             functions.clear();
             types.clear();
         }
-    } while (!syn->isSym(token, Symbol::CLOSE_PAR));
+    } while (moreFunctions);
 }
 
 // <durative-action-def> ::= (:durative-action <da-symbol>
@@ -354,7 +395,7 @@ void Parser::parseDurativeAction() {
     }
     syn->readSymbol(Symbol::EFFECT);
     DurativeEffect effect = parseDurativeEffect(parameters, controlVars);
-    task->addAction(name, parameters, controlVars, duration, condition, effect, syn);
+    task->addAction(name, parameters, controlVars, std::move(duration), std::move(condition), std::move(effect), syn);
     syn->closePar();
 }
 
@@ -387,11 +428,11 @@ void Parser::parseDurationConstraint(vector<Duration>& duration, const vector<Va
         }
     }
     else {    // =, <= or >=
+        Symbol comparator = token->symbol;
         Token* aux = syn->readSymbol(Symbol::VARIABLE);
         if (aux->description.compare("?duration") != 0)
             syn->notifyError("Variable ?duration expected");
-        NumericExpression exp = parseNumericExpression(parameters, controlVars);
-        duration.push_back(Duration(token->symbol, exp));
+        duration.emplace_back(comparator, parseNumericExpression(parameters, controlVars));
         syn->closePar();
     }
 }
@@ -409,7 +450,7 @@ NumericExpression Parser::parseNumericExpression(const vector<Variable>& paramet
     if (syn->isSym(token, Symbol::AT) || syn->isSym(token, Symbol::NAME)) {
         vector<Term> fncParams;
         syn->undoToken();
-        unsigned int fncIndex = !syn->isSym(token, Symbol::AT) ? task->getFunctionIndex(token->description)
+        unsigned int fncIndex = !syn->isSym(token, Symbol::AT) ? task->getFunctionIndex(token->id)
             : task->getFunctionIndex("at");
         if (fncIndex == MAX_UNSIGNED_INT) { // Constant
             NumericExpression exp;
@@ -439,6 +480,7 @@ NumericExpression Parser::parseNumericExpression(const vector<Variable>& paramet
         return NumericExpression(fncIndex, fncParams);
     }
     else {
+        Symbol operation = token->symbol;
         vector<NumericExpression> operands;
         bool moreOperands;
         do {
@@ -447,11 +489,10 @@ NumericExpression Parser::parseNumericExpression(const vector<Variable>& paramet
                 || syn->isSym(aux, Symbol::NAME) || syn->isSym(aux, Symbol::VARIABLE);
             if (moreOperands) {
                 syn->undoToken();
-                NumericExpression op = parseNumericExpression(parameters, controlVars);
-                operands.push_back(op);
+                operands.push_back(parseNumericExpression(parameters, controlVars));
             }
         } while (moreOperands);
-        return NumericExpression(token->symbol, operands, syn);
+        return NumericExpression(operation, std::move(operands), syn);
     }
 }
 
@@ -461,7 +502,7 @@ unsigned int Parser::parseFunctionHead(vector<Term>& fncParams, const vector<Var
     Token* token = syn->readSymbol(2, Symbol::NAME, Symbol::OPEN_PAR);
     unsigned int fncIndex;
     if (syn->isSym(token, Symbol::NAME)) {
-        fncIndex = task->getFunctionIndex(token->description);
+        fncIndex = task->getFunctionIndex(token->id);
         if (fncIndex == MAX_UNSIGNED_INT)
             syn->notifyError("Function '" + token->description + "' undefined");
         vector<Variable> controlVars;
@@ -525,7 +566,7 @@ Term Parser::parseTerm(const vector<Variable>& parameters, const vector<Variable
         }
     }
     else {
-        unsigned int objIndex = task->getObjectIndex(token->description);
+        unsigned int objIndex = task->getObjectIndex(token->id);
         if (objIndex == MAX_UNSIGNED_INT)
             syn->notifyError("Constant '" + token->description + "' undeclared");
         return Term(TERM_CONSTANT, objIndex);
@@ -675,10 +716,9 @@ void Parser::parseGoalDescription(GoalDescription& goal, const std::vector<Varia
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
         while (syn->isSym(token, Symbol::OPEN_PAR)) {
             syn->undoToken();
-            GoalDescription term;
-            term.time = TimeSpecifier::NONE;
-            parseGoalDescription(term, parameters, controlVars);
-            goal.terms.push_back(term);
+            goal.terms.emplace_back();
+            goal.terms.back().time = TimeSpecifier::NONE;
+            parseGoalDescription(goal.terms.back(), parameters, controlVars);
             token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
         }
         syn->undoToken();
@@ -699,6 +739,7 @@ Literal Parser::parseLiteral(const std::vector<Variable>& parameters) {
     literal.fncIndex = fncIndex;
     vector<Variable> controlVars;
     Function& f = task->functions[fncIndex];
+    literal.params.reserve(f.parameters.size());
     for (unsigned int i = 0; i < f.parameters.size(); i++) {
         Term term = parseTerm(f.parameters[i].types, parameters, controlVars);
         literal.params.push_back(term);
@@ -717,10 +758,9 @@ void Parser::parseADLGoalDescription(GoalDescription& goal, const std::vector<Va
     syn->closePar();
     vector<Variable> mergedParameters;
     mergeVariables(mergedParameters, parameters, goal.parameters);
-    GoalDescription term;
-    term.time = TimeSpecifier::NONE;
-    parseGoalDescription(term, mergedParameters, controlVars);
-    goal.terms.push_back(term);
+    goal.terms.emplace_back();
+    goal.terms.back().time = TimeSpecifier::NONE;
+    parseGoalDescription(goal.terms.back(), mergedParameters, controlVars);
 }
 
 // <atomic formula(t)> ::=:equality = t t
@@ -867,10 +907,9 @@ void Parser::parseTimedEffect(TimedEffect& timedEffect, const std::vector<Variab
         token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
         while (syn->isSym(token, Symbol::OPEN_PAR)) {
             syn->undoToken();
-            TimedEffect aux;
-            aux.time = TimeSpecifier::NONE;
-            parseTimedEffect(aux, parameters, controlVars);
-            timedEffect.terms.push_back(aux);
+            timedEffect.terms.emplace_back();
+            timedEffect.terms.back().time = TimeSpecifier::NONE;
+            parseTimedEffect(timedEffect.terms.back(), parameters, controlVars);
             token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
         }
         syn->undoToken();
@@ -878,10 +917,9 @@ void Parser::parseTimedEffect(TimedEffect& timedEffect, const std::vector<Variab
     case Symbol::NOT:
     {
         timedEffect.type = TE_NOT;
-        TimedEffect aux;
-        aux.time = TimeSpecifier::NONE;
-        parseTimedEffect(aux, parameters, controlVars);
-        timedEffect.terms.push_back(aux);
+        timedEffect.terms.emplace_back();
+        timedEffect.terms.back().time = TimeSpecifier::NONE;
+        parseTimedEffect(timedEffect.terms.back(), parameters, controlVars);
     }
     break;
     case Symbol::NAME:
@@ -918,7 +956,7 @@ FluentAssignment Parser::parseFluentAssignment(const vector<Variable>& parameter
     assignment.fluent.fncIndex = parseFunctionHead(fncParams, parameters);
     for (unsigned int i = 0; i < fncParams.size(); i++)
         assignment.fluent.params.push_back(fncParams[i]);
-    assignment.exp = parseEffectExpression(parameters, controlVars, syn->isSym(token, Symbol::ASSIGN));
+    assignment.exp = parseEffectExpression(parameters, controlVars, assignment.type == AS_ASSIGN);
     return assignment;
 }
 
@@ -1024,7 +1062,7 @@ void Parser::parseAction() {
             syn->closePar();
         }
     }
-    task->addAction(name, parameters, precondition, effect, syn);
+    task->addAction(name, parameters, std::move(precondition), std::move(effect), syn);
 }
 
 // <pre-GD> ::= <pref-GD>
@@ -1175,6 +1213,8 @@ Effect Parser::parseEffect(const std::vector<Variable>& parameters, const std::v
 }
 
 // <object declaration> ::= (:objects <typed list (name)>)
+// Unlike :init, this section is always parsed sequentially: each name is new, so it must be
+// interned in the shared symbol table and get the next object index, in the order of the file
 void Parser::parseObjects() {
     Token* token = syn->readSymbol(2, Symbol::NAME, Symbol::CLOSE_PAR);
     vector<string> objNames;
@@ -1204,50 +1244,133 @@ void Parser::parseObjects() {
 // <basic-function-term> ::= <function-symbol>
 // <basic-function-term> ::= (<function-symbol> <name>*)
 void Parser::parseInit() {
-    Token* token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
-    float time;
-    while (syn->isSym(token, Symbol::OPEN_PAR)) {
-        token = syn->readSymbol(4, Symbol::EQUAL, Symbol::AT, Symbol::OVER, Symbol::NAME);
-        Fact f;
-        if (syn->isSym(token, Symbol::EQUAL)) {
-            f = parseFact();
-            syn->closePar();
+    ProfileScope profile("parseInit");
+    size_t numFacts = task->init.size() + task->initAtoms.size();
+    if (!parseInitChunks()) {
+        Token* token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
+        while (syn->isSym(token, Symbol::OPEN_PAR)) {
+            parseInitElement(task->initAtoms, task->init);
+            token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
         }
-        else {
-            bool til = false;
-            if (syn->isSym(token, Symbol::AT)) {
-                Token* aux = syn->nextToken();
-                if (syn->isSym(aux, Symbol::NUMBER)) {
-                    til = true;
+    }
+    profile.count("facts", task->init.size() + task->initAtoms.size() - numFacts);
+}
+
+// Parses a large :init section in parallel: the elements are split into chunks that are
+// parsed by separate threads (the names are only looked up, as every name in the section
+// must have been declared before) and then appended to the task in order. Returns false
+// if the section must be parsed sequentially
+bool Parser::parseInitChunks() {
+    int numThreads = maxThreads > 0 ? (int)maxThreads : (int)thread::hardware_concurrency();
+    vector<TextChunk> chunks;
+    if (numThreads < 2 || !syn->splitList(numThreads, minInitChunkSize, chunks)) return false;
+    int numChunks = (int)chunks.size();
+    vector<AtomStore> atoms(numChunks);
+    vector< vector<Fact> > facts(numChunks);
+    vector<exception_ptr> errors(numChunks);
+    vector<long> numTokens(numChunks);
+    {
+        WorkStealingPool pool(numThreads);
+        pool.start(numChunks, [&](int i) {
+            Parser chunkParser;
+            chunkParser.task = task;
+            chunkParser.syn = new SyntaxAnalyzer(*syn, chunks[i]);
+            try {
+                while (!chunkParser.syn->endOfInput()) {
+                    chunkParser.syn->openPar();
+                    chunkParser.parseInitElement(atoms[i], facts[i]);
                 }
-                syn->undoToken();
             }
-            if (!til) {
-                syn->undoToken();
-                f = parseFact();
+            catch (...) {       // Rethrown by the calling thread (the analyzer is released by the parser)
+                errors[i] = current_exception();
             }
-            else {
-                time = syn->readSymbol(Symbol::NUMBER)->value;
+            numTokens[i] = chunkParser.syn->numTokens();
+        });
+        pool.wait();
+    }
+    for (int i = 0; i < numChunks; i++) {
+        if (errors[i] != nullptr) rethrow_exception(errors[i]);
+    }
+    for (int i = 0; i < numChunks; i++) {
+        task->initAtoms.append(atoms[i]);
+        task->init.insert(task->init.end(), facts[i].begin(), facts[i].end());
+        syn->countChunkTokens(numTokens[i]);
+    }
+    syn->closePar();
+    return true;
+}
+
+// <init-el>, once its opening parenthesis has been read. Plain atoms are stored in the
+// given atom store and the other elements in the list of facts
+void Parser::parseInitElement(AtomStore& atoms, vector<Fact>& facts) {
+    Token* token = syn->readSymbol(4, Symbol::EQUAL, Symbol::AT, Symbol::OVER, Symbol::NAME);
+    Fact f;
+    bool atom = false;
+    if (syn->isSym(token, Symbol::EQUAL)) {
+        f = parseFact();
+        syn->closePar();
+    }
+    else {
+        bool til = false;
+        if (syn->isSym(token, Symbol::AT)) {
+            Token* aux = syn->nextToken();
+            if (syn->isSym(aux, Symbol::NUMBER)) {
+                til = true;
+            }
+            syn->undoToken();
+        }
+        if (!til) {
+            syn->undoToken();
+            atom = parseInitAtom(atoms);
+            if (!atom) f = parseFact();
+        }
+        else {
+            float time = syn->readSymbol(Symbol::NUMBER)->value;
+            syn->openPar();
+            token = syn->nextToken();
+            if (syn->isSym(token, Symbol::NOT)) {
                 syn->openPar();
-                token = syn->nextToken();
-                if (syn->isSym(token, Symbol::NOT)) {
-                    syn->openPar();
-                    f = parseFact();
-                    syn->closePar();
-                    f.value = f.value == task->CONSTANT_TRUE ? task->CONSTANT_FALSE : task->CONSTANT_TRUE;
-                }
-                else {
-                    syn->undoToken();
-                    f = parseFact();
-                }
-                f.time = time;
+                f = parseFact();
                 syn->closePar();
+                f.value = f.value == task->CONSTANT_TRUE ? task->CONSTANT_FALSE : task->CONSTANT_TRUE;
             }
+            else {
+                syn->undoToken();
+                f = parseFact();
+            }
+            f.time = time;
             syn->closePar();
         }
-        task->init.push_back(f);
-        token = syn->readSymbol(2, Symbol::OPEN_PAR, Symbol::CLOSE_PAR);
+        syn->closePar();
+    }
+    if (!atom) facts.push_back(std::move(f));
+}
+
+// <literal(name)> of a predicate: fast path for the plain atoms of the initial state,
+// that are stored directly in the given columnar store. Returns false, without
+// consuming any token, if the function is not a predicate (the fact must be parsed
+// by parseFact)
+bool Parser::parseInitAtom(AtomStore& atoms) {
+    Token* token = syn->nextToken();
+    unsigned int function = task->getFunctionIndex(token->id);
+    if (function == MAX_UNSIGNED_INT || !task->isBooleanFunction(function)) {
+        syn->undoToken();
+        return false;
+    }
+    Function& fnc = task->functions[function];
+    unsigned int numParams = (unsigned int)fnc.parameters.size();
+    for (unsigned int i = 0; i < numParams; i++) {
+        token = syn->readNameToken();
+        unsigned int objIndex = task->getObjectIndex(token->id);
+        if (objIndex == MAX_UNSIGNED_INT)
+            syn->notifyError("Object '" + token->description + "' undefined");
+        Object& obj = task->objects[objIndex];
+        if (!task->compatibleTypes(obj.types, fnc.parameters[i].types))
+            syn->notifyError("Invalid parameter '" + obj.name + "'");
+        atoms.addArgument(objIndex);
     }
+    atoms.endAtom(function);
+    return true;
 }
 
 // <literal(name)> | <basic-function-term> <number> | <basic-function-term> <name>
@@ -1261,7 +1384,7 @@ Fact Parser::parseFact() {
         closePar = true;
         token = syn->readSymbol(3, Symbol::AT, Symbol::OVER, Symbol::NAME);
     }
-    fact.function = task->getFunctionIndex(token->description);
+    fact.function = task->getFunctionIndex(token->id);
     if (fact.function == MAX_UNSIGNED_INT)
         syn->notifyError("Function '" + token->description + "' undefined");
     Function& function = task->functions[fact.function];
@@ -1280,7 +1403,7 @@ Fact Parser::parseFact() {
         syn->closePar();
         token = syn->readSymbol(2, Symbol::NAME, Symbol::NUMBER);
         if (syn->isSym(token, Symbol::NAME)) {
-            unsigned int objIndex = task->getObjectIndex(token->description);
+            unsigned int objIndex = task->getObjectIndex(token->id);
             if (objIndex == MAX_UNSIGNED_INT)
                 syn->notifyError("Object '" + token->description + "' undefined");
             Object& obj = task->objects[objIndex];
@@ -1531,10 +1654,9 @@ Constraint Parser::parseConstraint(const vector<Variable>& parameters, const vec
 
 // Adds a <GD> to the given constraint
 void Parser::parseConstraintGoal(Constraint& constraint, const vector<Variable>& parameters, const std::vector<Variable>& controlVars) {
-    GoalDescription g;
-    g.time = NONE;
-    parseGoalDescription(g, parameters, controlVars);
-    constraint.goal.push_back(g);
+    constraint.goal.emplace_back();
+    constraint.goal.back().time = NONE;
+    parseGoalDescription(constraint.goal.back(), parameters, controlVars);
 }
 
 // <derived-def> ::= (:derived <atomic formula skeleton> <GD>)
@@ -1544,7 +1666,7 @@ void Parser::parseDerivedPredicates() {
     d.function = parsePredicate();
     parseGoalDescription(d.goal, d.function.parameters, controlVars);
     syn->closePar();
-    task->derivedPredicates.push_back(d);
+    task->derivedPredicates.push_back(std::move(d));
 }
 
 // <length-spec> ::= (:length [(:serial <integer>)] [(:parallel <integer>)])
@@ -16,6 +16,7 @@ class Parser {
 private:
     SyntaxAnalyzer* syn;
     ParsedTask* task;
+    static unsigned int maxThreads;
     void parseRequirements();
     void parseTypes();
     void parseParentTypes(std::vector<unsigned int>& types, bool allowNumber);
@@ -59,18 +60,25 @@ private:
     Effect parseEffect(const std::vector<Variable>& parameters, const std::vector<Variable>& controlVars);
     void parseObjects();
     void parseInit();
+    bool parseInitChunks();
+    void parseInitElement(AtomStore& atoms, std::vector<Fact>& facts);
+    bool parseInitAtom(AtomStore& atoms);
     Fact parseFact();
     void parseGoal();
     void parseMetric();
     Metric parseMetricExpression();
     unsigned int parseFluent(std::vector<unsigned int>& parameters);
     void parseLength();
+    ParsedTask* parseProblem();
 
 public:
     Parser();
     ~Parser();
     ParsedTask* parseDomain(char* domainFileName);
     ParsedTask* parseProblem(char* problemFileName);
+    ParsedTask* parseProblem(char* problemFileName, ParsedTask* domainTask);
+    ParsedTask* parseProblem(const char* problemName, const char* buffer, size_t length, ParsedTask* domainTask);
+    static void setMaxThreads(unsigned int max) { maxThreads = max; }
 };
 
 #endif
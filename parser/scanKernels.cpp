@@ -0,0 +1,183 @@
+/********************************************************/
+/* Scanning kernels of the syntactic analyzer: skip     */
+/* spaces and name characters 16 (SSE2) or 32 (AVX2)    */
+/* bytes at a time. The implementation is chosen at     */
+/* runtime from the features of the processor, with a   */
+/* scalar fallback.                                     */
+/********************************************************/
+
+#include "scanKernels.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+
+/********************************************************/
+/* Scalar implementation                                */
+/********************************************************/
+
+// Checks if a character can be part of a name
+static inline bool isNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+}
+
+// Skips spaces one character at a time. Characters are signed, so bytes over 127 are
+// also skipped (as the analyzer always did)
+static int scalarSkipSpaces(const char* text, int position, int length, int& lines) {
+    while (position < length && text[position] <= ' ') {
+        if (text[position] == '\n') lines++;
+        position++;
+    }
+    return position;
+}
+
+// Skips name characters one at a time
+static int scalarSkipName(const char* text, int position, int length, bool& capitals) {
+    while (position < length && isNameChar(text[position])) {
+        if (text[position] >= 'A' && text[position] <= 'Z') capitals = true;
+        position++;
+    }
+    return position;
+}
+
+#ifdef SCAN_X86
+
+/********************************************************/
+/* SSE2 implementation (16 bytes per step)              */
+/********************************************************/
+
+// Mask of the bytes in [first, first + count)
+static inline __m128i inRange16(__m128i v, char first, char count) {
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - first)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(0x80 + count)));
+}
+
+// Skips spaces 16 bytes at a time
+static int sse2SkipSpaces(const char* text, int position, int length, int& lines) {
+    const __m128i space = _mm_set1_epi8(' '), newLine = _mm_set1_epi8('\n');
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + position));
+        unsigned int nonSpaces = (unsigned int)_mm_movemask_epi8(_mm_cmpgt_epi8(v, space));
+        unsigned int newLines = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newLine));
+        if (nonSpaces != 0) {
+            int n = __builtin_ctz(nonSpaces);
+            lines += __builtin_popcount(newLines & ((1u << n) - 1));
+            return position + n;
+        }
+        lines += __builtin_popcount(newLines);
+        position += 16;
+    }
+    return scalarSkipSpaces(text, position, length, lines);
+}
+
+// Skips name characters 16 bytes at a time
+static int sse2SkipName(const char* text, int position, int length, bool& capitals) {
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + position));
+        __m128i upper = inRange16(v, 'A', 26);
+        __m128i valid = _mm_or_si128(_mm_or_si128(inRange16(v, 'a', 26), upper),
+            _mm_or_si128(inRange16(v, '0', 10), _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('_')))));
+        unsigned int invalid = ~(unsigned int)_mm_movemask_epi8(valid) & 0xFFFF;
+        unsigned int uppercase = (unsigned int)_mm_movemask_epi8(upper);
+        if (invalid != 0) {
+            int n = __builtin_ctz(invalid);
+            if ((uppercase & ((1u << n) - 1)) != 0) capitals = true;
+            return position + n;
+        }
+        if (uppercase != 0) capitals = true;
+        position += 16;
+    }
+    return scalarSkipName(text, position, length, capitals);
+}
+
+/********************************************************/
+/* AVX2 implementation (32 bytes per step)              */
+/********************************************************/
+
+// Mask of the bytes in [first, first + count)
+__attribute__((target("avx2")))
+static inline __m256i inRange32(__m256i v, char first, char count) {
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - first)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + count)), shifted);
+}
+
+// Skips spaces 32 bytes at a time
+__attribute__((target("avx2")))
+static int avx2SkipSpaces(const char* text, int position, int length, int& lines) {
+    const __m256i space = _mm256_set1_epi8(' '), newLine = _mm256_set1_epi8('\n');
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + position));
+        unsigned int nonSpaces = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, space));
+        unsigned int newLines = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newLine));
+        if (nonSpaces != 0) {
+            int n = __builtin_ctz(nonSpaces);
+            lines += __builtin_popcount(newLines & ((1u << n) - 1));
+            return position + n;
+        }
+        lines += __builtin_popcount(newLines);
+        position += 32;
+    }
+    return sse2SkipSpaces(text, position, length, lines);
+}
+
+// Skips name characters 32 bytes at a time
+__attribute__((target("avx2")))
+static int avx2SkipName(const char* text, int position, int length, bool& capitals) {
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + position));
+        __m256i upper = inRange32(v, 'A', 26);
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(inRange32(v, 'a', 26), upper),
+            _mm256_or_si256(inRange32(v, '0', 10), _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')))));
+        unsigned int invalid = ~(unsigned int)_mm256_movemask_epi8(valid);
+        unsigned int uppercase = (unsigned int)_mm256_movemask_epi8(upper);
+        if (invalid != 0) {
+            int n = __builtin_ctz(invalid);
+            if (n > 0 && (uppercase << (32 - n)) != 0) capitals = true;
+            return position + n;
+        }
+        if (uppercase != 0) capitals = true;
+        position += 32;
+    }
+    return sse2SkipName(text, position, length, capitals);
+}
+
+#endif
+
+/********************************************************/
+/* CLASS: ScanKernels                                   */
+/********************************************************/
+
+#ifdef SCAN_X86
+
+// Checks if the processor supports AVX2
+static bool supportsAVX2() {
+    __builtin_cpu_init();   // Needed as this runs during the static initialization
+    return __builtin_cpu_supports("avx2");
+}
+
+// The implementation is selected during the static initialization, before any thread
+// can use the kernels. SSE2 is always available in x86-64
+static const bool useAVX2 = supportsAVX2();
+
+int (*ScanKernels::skipSpaces)(const char*, int, int, int&) = useAVX2 ? avx2SkipSpaces : sse2SkipSpaces;
+int (*ScanKernels::skipName)(const char*, int, int, bool&) = useAVX2 ? avx2SkipName : sse2SkipName;
+
+// Returns the name of the selected implementation
+const char* ScanKernels::implementation() {
+    return useAVX2 ? "avx2" : "sse2";
+}
+
+#else
+
+int (*ScanKernels::skipSpaces)(const char*, int, int, int&) = scalarSkipSpaces;
+int (*ScanKernels::skipName)(const char*, int, int, bool&) = scalarSkipName;
+
+// Returns the name of the selected implementation
+const char* ScanKernels::implementation() {
+    return "scalar";
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+/********************************************************/
+/* Scanning kernels of the syntactic analyzer: skip     */
+/* spaces and name characters 16 (SSE2) or 32 (AVX2)    */
+/* bytes at a time. The implementation is chosen at     */
+/* runtime from the features of the processor, with a   */
+/* scalar fallback.                                     */
+/********************************************************/
+
+class ScanKernels {
+public:
+    // Returns the position of the first character greater than ' ' from the given one
+    // (or length if there is none), and adds the number of skipped line breaks to lines
+    static int (*skipSpaces)(const char* text, int position, int length, int& lines);
+    // Returns the position of the first character that cannot be part of a name
+    // ([a-zA-Z0-9_-]) from the given one. Sets capitals if any skipped letter is uppercase
+    static int (*skipName)(const char* text, int position, int length, bool& capitals);
+    // Name of the selected implementation ("avx2", "sse2" or "scalar")
+    static const char* implementation();
+};
+
+#endif
@@ -0,0 +1,72 @@
+/********************************************************/
+/* Interning table: assigns a dense integer identifier  */
+/* to each distinct name read by the lexer, so that the */
+/* names can be compared and indexed as integers.       */
+/********************************************************/
+
+#include "symbolTable.h"
+#include <cstring>
+using namespace std;
+
+// Creates an empty table
+SymbolTable::SymbolTable() {
+    offsets.push_back(0);
+    slots.resize(256, 0);
+}
+
+// FNV-1a hash of a name
+unsigned int SymbolTable::hash(const char* name, int length) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < length; i++)
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    return h;
+}
+
+// Returns the slot that contains the given name, or the empty slot where it should be stored
+unsigned int SymbolTable::findSlot(const char* name, int length, unsigned int h) {
+    unsigned int mask = (unsigned int)slots.size() - 1;
+    unsigned int slot = h & mask;
+    while (slots[slot] != 0) {
+        unsigned int id = slots[slot] - 1;
+        if (hashes[id] == h && offsets[id + 1] - offsets[id] == (unsigned int)length &&
+            memcmp(&text[offsets[id]], name, length) == 0)
+            break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Doubles the size of the hash table
+void SymbolTable::grow() {
+    slots.assign(slots.size() * 2, 0);
+    unsigned int mask = (unsigned int)slots.size() - 1;
+    for (unsigned int id = 0; id < hashes.size(); id++) {
+        unsigned int slot = hashes[id] & mask;
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        slots[slot] = id + 1;
+    }
+}
+
+// Returns the identifier of a name, given its hash, adding it to the table if it is new
+unsigned int SymbolTable::intern(const char* name, int length, unsigned int h) {
+    unsigned int slot = findSlot(name, length, h);
+    if (slots[slot] != 0) return slots[slot] - 1;
+    unsigned int id = size();
+    text.insert(text.end(), name, name + length);
+    offsets.push_back((unsigned int)text.size());
+    hashes.push_back(h);
+    slots[slot] = id + 1;
+    if (hashes.size() * 2 > slots.size()) grow();   // Load factor <= 0.5
+    return id;
+}
+
+// Returns the identifier of a name, or NOT_FOUND if it is not in the table
+unsigned int SymbolTable::find(const char* name, int length) {
+    unsigned int slot = findSlot(name, length, hash(name, length));
+    return slots[slot] != 0 ? slots[slot] - 1 : NOT_FOUND;
+}
+
+// Returns the name with the given identifier
+string SymbolTable::name(unsigned int id) {
+    return string(&text[offsets[id]], offsets[id + 1] - offsets[id]);
+}
@@ -0,0 +1,37 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+/********************************************************/
+/* Interning table: assigns a dense integer identifier  */
+/* to each distinct name read by the lexer, so that the */
+/* names can be compared and indexed as integers.       */
+/********************************************************/
+
+#include <string>
+#include <vector>
+
+class SymbolTable {
+private:
+    std::vector<char> text;                 // Names, one after another
+    std::vector<unsigned int> offsets;      // Position of each name in text (one more entry at the end)
+    std::vector<unsigned int> slots;        // Open-addressing hash table: identifier + 1 (0 = empty)
+    std::vector<unsigned int> hashes;       // Hash of each name
+
+    static unsigned int hash(const char* name, int length);
+    unsigned int findSlot(const char* name, int length, unsigned int h);
+    void grow();
+    unsigned int intern(const char* name, int length, unsigned int h);
+
+public:
+    static const unsigned int NOT_FOUND = 0xFFFFFFFF;
+
+    SymbolTable();
+    inline unsigned int intern(const char* name, int length) { return intern(name, length, hash(name, length)); }
+    inline unsigned int intern(const std::string& name) { return intern(name.c_str(), (int)name.length()); }
+    unsigned int find(const char* name, int length);
+    inline unsigned int find(const std::string& name) { return find(name.c_str(), (int)name.length()); }
+    inline unsigned int size() { return (unsigned int)offsets.size() - 1; }
+    std::string name(unsigned int id);
+};
+
+#endif
@@ -7,11 +7,18 @@
 /********************************************************/
 
 #include "syntaxAnalyzer.h"
-#include <fstream>
+#include "scanKernels.h"
+#include "../utils/profiler.h"
 #include <cstring>
-#include <iostream>
 #include <algorithm>
+#include <iostream>
 #include <cstdarg>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 /********************************************************/
@@ -21,24 +28,27 @@ using namespace std;
 // Creates a new token
 Token::Token(Symbol s) {
     symbol = s;
+    id = SymbolTable::NOT_FOUND;
 }
 
 // Creates a numeric token
 Token::Token(float v) {
     symbol = Symbol::NUMBER;
+    id = SymbolTable::NOT_FOUND;
     value = v;
 }
 
-// Creates a string token
-Token::Token(Symbol s, string const& desc) {
+// Creates a token with a text
+Token::Token(Symbol s, const TokenText& desc, unsigned int id) {
     symbol = s;
     description = desc;
+    this->id = id;
 }
 
 // Returns a string representation of this token
 string Token::toString() {
     if (symbol == Symbol::NUMBER) return std::to_string(value);
-    else if (symbol == Symbol::NAME || symbol == Symbol::VARIABLE) return description;
+    else if (symbol == Symbol::NAME || symbol == Symbol::VARIABLE) return description.str();
     else return symbolDescriptions[symbol];
 }
 
@@ -46,128 +56,486 @@ string Token::toString() {
 /* CLASS: SyntaxAnalyzer (Syntatic analyzer)            */
 /********************************************************/
 
-// Creates a new syntactic analyzer for parsing a given file
-SyntaxAnalyzer::SyntaxAnalyzer(char* fileName) {
+// Creates a new syntactic analyzer for parsing a given file ("-" for the standard input).
+// Regular files are memory-mapped and scanned in place, without copying them. Other
+// inputs (pipes, terminals) and compressed files (gzip, zstd) are read in chunks while
+// scanning
+SyntaxAnalyzer::SyntaxAnalyzer(char* fileName, SymbolTable* symbolTable) {
+    ProfileScope profile("readFile");
     this->fileName = fileName;
-    ifstream in(fileName);
-    if (in.fail()) {
-        cout << "File not found: " << fileName << endl;
-        exit(1);
+    this->symbolTable = symbolTable;
+    readOnlySymbols = false;
+    buffer = nullptr;
+    ownedBuffer = nullptr;
+    bufferCapacity = 0;
+    input = -1;
+    decompressor = nullptr;
+    mappedLength = 0;
+    bufferLength = 0;
+    int fd = strcmp(fileName, "-") == 0 ? dup(STDIN_FILENO) : open(fileName, O_RDONLY);
+    if (fd == -1) {
+        throw ParseError(1, "File not found: " + string(fileName));
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED && Decompressor::detect((const char*)map, st.st_size) != CF_NONE) {
+            munmap(map, st.st_size);
+            map = MAP_FAILED;
+        }
+        if (map != MAP_FAILED) {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            buffer = (const char*)map;
+            mappedLength = st.st_size;
+            bufferLength = (int)st.st_size;
+        }
+    }
+    if (buffer == nullptr) {
+        bufferCapacity = 65536;
+        ownedBuffer = (char*)malloc(bufferCapacity);
+        buffer = ownedBuffer;
+        input = fd;
+    }
+    else close(fd);
+    initialize();
+    if (input != -1) detectCompression();
+    profile.count("bytes", bufferLength);
+}
+
+// Creates a new syntactic analyzer for parsing a text in memory. The name is only used
+// in the error messages. The text is not copied, so it must not be released until the
+// parsing ends
+SyntaxAnalyzer::SyntaxAnalyzer(const char* name, const char* contents, size_t length, SymbolTable* symbolTable) {
+    this->fileName = name;
+    this->symbolTable = symbolTable;
+    readOnlySymbols = false;
+    buffer = contents;
+    ownedBuffer = nullptr;
+    bufferCapacity = 0;
+    input = -1;
+    decompressor = nullptr;
+    mappedLength = 0;
+    bufferLength = (int)length;
+    initialize();
+}
+
+// Creates a new syntactic analyzer for a chunk of the text of another one (see splitList).
+// The names are looked up in the symbol table instead of being interned, so that several
+// chunks can be read at the same time. Unknown names get the identifier NOT_FOUND
+SyntaxAnalyzer::SyntaxAnalyzer(const SyntaxAnalyzer& parent, const TextChunk& chunk) {
+    fileName = parent.fileName;
+    symbolTable = parent.symbolTable;
+    readOnlySymbols = true;
+    buffer = parent.buffer;
+    ownedBuffer = nullptr;
+    bufferCapacity = 0;
+    input = -1;
+    decompressor = nullptr;
+    mappedLength = 0;
+    bufferLength = chunk.end;
+    initialize();
+    position = chunk.start;
+    lineNumber = chunk.line;
+}
+
+// Reads the next chunk of a streamed input. The text before the current position is
+// discarded (the texts of the tokens in the window are copies), so the buffer only grows
+// if a single token does not fit in it. Returns false at the end of the input
+bool SyntaxAnalyzer::fillBuffer() {
+    if (input == -1) return false;
+    int pending = bufferLength - position;
+    if (position > 0) memmove(ownedBuffer, ownedBuffer + position, pending);
+    else if (pending == bufferCapacity) {
+        bufferCapacity *= 2;
+        ownedBuffer = (char*)realloc(ownedBuffer, bufferCapacity);
+        buffer = ownedBuffer;
+    }
+    position = 0;
+    bufferLength = pending;
+    ssize_t n;
+    if (decompressor != nullptr) {
+        n = decompressor->read(input, ownedBuffer + bufferLength, bufferCapacity - bufferLength);
+        if (n < 0) notifyError("Corrupted or truncated compressed input");
+    }
+    else {
+        do {
+            n = read(input, ownedBuffer + bufferLength, bufferCapacity - bufferLength);
+        } while (n == -1 && errno == EINTR);
+    }
+    if (n <= 0) {
+        close(input);
+        input = -1;
+        return false;
     }
-    string contents((istreambuf_iterator<char>(in)),
-        istreambuf_iterator<char>());
-    std::transform(contents.begin(), contents.end(), contents.begin(), ::tolower);
-    bufferLength = contents.length() + 1;
-    buffer = new char[bufferLength];
-    strcpy(buffer, contents.c_str());
+    bufferLength += (int)n;
+    return true;
+}
+
+// Reads the first bytes of a streamed input and, if they are the magic number of a
+// compressed format, decompresses the rest of the input while scanning it
+void SyntaxAnalyzer::detectCompression() {
+    while (bufferLength < 4 && fillBuffer());
+    CompressionFormat format = Decompressor::detect(buffer, bufferLength);
+    if (format == CF_NONE) return;
+    if (!Decompressor::isSupported(format)) {
+        free(ownedBuffer);      // The destructor is not called if the constructor fails
+        if (input != -1) close(input);
+        throw ParseError(1, "Compressed format not supported (zstd requires building with ZSTD=1): "
+            + string(fileName));
+    }
+    decompressor = new Decompressor(format, buffer, bufferLength);
+    bufferLength = 0;
+}
+
+// Makes sure that the whole token starting at the current position is in the buffer of
+// a streamed input: tokens never contain spaces, parentheses or comments
+void SyntaxAnalyzer::completeToken() {
+    int end = position + 1;
+    do {
+        while (end < bufferLength) {
+            char c = buffer[end];
+            if (c <= ' ' || c == '(' || c == ')' || c == ';') return;
+            end++;
+        }
+        end -= position;
+        if (!fillBuffer()) return;
+        end += position;
+    } while (true);
+}
+
+// Prepares the analyzer to read the first token
+void SyntaxAnalyzer::initialize() {
     tokenIndex = 0;
+    tokenCount = 0;
+    chunkTokenCount = 0;
+    tokens.assign(tokenWindowSize, Token(Symbol::CLOSE_PAR));
     lineNumber = 1;
     position = 0;
-    tokens.reserve(8096);
-    for (unsigned int i = 0; i < numSymbols; i++) {
-        if (symbolNames[i] != nullptr)
-            symbols[symbolNames[i]] = (Symbol)i;
-    }
 }
 
 // Disposes the syntatic analyzer
 SyntaxAnalyzer::~SyntaxAnalyzer() {
-    delete[] buffer;
-    for (unsigned int i = 0; i < tokens.size(); i++)
-        delete tokens[i];
-    tokens.clear();
-    symbols.clear();
+    if (mappedLength > 0) munmap((void*)buffer, mappedLength);
+    if (ownedBuffer != nullptr) free(ownedBuffer);
+    if (decompressor != nullptr) delete decompressor;
+    if (input != -1) close(input);
 }
 
 // Returns the next token in the file
 Token* SyntaxAnalyzer::nextToken() {
     if (tokenIndex < 0) {
+        Token* token = &tokens[(tokenCount + tokenIndex) & (tokenWindowSize - 1)];
         tokenIndex++;
-        return tokens[tokens.size() + tokenIndex - 1];
+        return token;
     }
     else {
-        skipSpaces();   // Skip comments and spaces
-        while (position < bufferLength) {
-            if (buffer[position] == ';' || buffer[position] == '\\') {
-                while (position < bufferLength && buffer[position] != '\n')
-                    position++;
-                skipSpaces();
-            }
-            else break;
-        }
+        skipBlanks();
         Token* token;
-        if (position < bufferLength) token = matchToken();
+        if (position < bufferLength) {
+            if (input != -1) completeToken();
+            token = matchToken();
+        }
         else token = nullptr;
         if (token == nullptr)
             notifyError("Reached end of file");
-        tokens.push_back(token);
         return token;
     }
 }
 
-// Computes the type of the next token
+// Skips the spaces and comments before the next token
+void SyntaxAnalyzer::skipBlanks() {
+    skipSpaces();
+    while (position < bufferLength) {
+        if (buffer[position] == ';' || buffer[position] == '\\') {
+            do {
+                const char* end = (const char*)memchr(buffer + position, '\n', bufferLength - position);
+                position = end != nullptr ? (int)(end - buffer) : bufferLength;
+            } while (position == bufferLength && fillBuffer());
+            skipSpaces();
+        }
+        else break;
+    }
+}
+
+// Checks if there are no more tokens to read
+bool SyntaxAnalyzer::endOfInput() {
+    if (tokenIndex < 0) return false;
+    skipBlanks();
+    return position >= bufferLength;
+}
+
+// Splits the remaining elements of the current list into at most maxChunks chunks of at
+// least minChunkSize bytes. Each chunk starts at an element of the list (a parenthesis at
+// the top level of the list), so it can be read by a separate analyzer. The analyzer then
+// moves to the closing parenthesis of the list. Returns false, without moving, if the
+// input is streamed, the list is too short or it contains '\' comments
+bool SyntaxAnalyzer::splitList(int maxChunks, int minChunkSize, vector<TextChunk>& chunks) {
+    if (input != -1 || tokenIndex < 0 || bufferLength - position < 2 * minChunkSize) return false;
+    int granule = minChunkSize / 16;    // Minimum distance between two candidate split points
+    vector<TextChunk> candidates;
+    candidates.push_back(TextChunk{position, 0, lineNumber});
+    int pos = position, line = lineNumber, depth = 0, nextCandidate = position + granule;
+    while (pos < bufferLength) {
+        char c = buffer[pos];
+        if (c == '(') {
+            if (depth == 0 && pos >= nextCandidate) {
+                candidates.push_back(TextChunk{pos, 0, line});
+                nextCandidate = pos + granule;
+            }
+            depth++;
+        }
+        else if (c == ')') {
+            if (depth == 0) break;
+            depth--;
+        }
+        else if (c == '\n') line++;
+        else if (c == ';') {
+            const char* end = (const char*)memchr(buffer + pos, '\n', bufferLength - pos);
+            pos = end != nullptr ? (int)(end - buffer) : bufferLength;
+            continue;
+        }
+        else if (c == '\\') return false;
+        pos++;
+    }
+    int length = pos - position;
+    int numChunks = min(maxChunks, length / minChunkSize);
+    if (pos >= bufferLength || numChunks < 2) return false;     // The sequential parser reports the errors
+    chunks.clear();
+    unsigned int c = 0;
+    for (int i = 1; i < numChunks; i++) {
+        int target = position + (int)((long)length * i / numChunks);
+        while (c < candidates.size() && candidates[c].start < target) c++;
+        if (c == candidates.size()) break;
+        if (chunks.empty() || chunks.back().start < candidates[c].start) {
+            chunks.push_back(candidates[c]);
+        }
+    }
+    if (chunks.empty()) return false;
+    chunks.insert(chunks.begin(), candidates[0]);
+    for (unsigned int i = 0; i + 1 < chunks.size(); i++)
+        chunks[i].end = chunks[i + 1].start;
+    chunks.back().end = pos;
+    position = pos;
+    lineNumber = line;
+    return true;
+}
+
+// Computes the type of the next token and stores it
 Token* SyntaxAnalyzer::matchToken() {
-    Token* token = nullptr;
+    Symbol symbol = Symbol::NAME;
+    bool isSymbol = true;
     switch (buffer[position]) {
-    case '(': token = new Token(Symbol::OPEN_PAR);  break;
-    case ')': token = new Token(Symbol::CLOSE_PAR); break;
-    case ':': token = new Token(Symbol::COLON);     break;
-    case '-': token = new Token(Symbol::MINUS);     break;
-    case '+': token = new Token(Symbol::PLUS);      break;
-    case '/': token = new Token(Symbol::DIV);       break;
-    case '*': token = new Token(Symbol::PROD);      break;
-    case '=': token = new Token(Symbol::EQUAL);     break;
+    case '(': symbol = Symbol::OPEN_PAR;  break;
+    case ')': symbol = Symbol::CLOSE_PAR; break;
+    case ':': symbol = Symbol::COLON;     break;
+    case '-': symbol = Symbol::MINUS;     break;
+    case '+': symbol = Symbol::PLUS;      break;
+    case '/': symbol = Symbol::DIV;       break;
+    case '*': symbol = Symbol::PROD;      break;
+    case '=': symbol = Symbol::EQUAL;     break;
     case '>':
-        if (buffer[position + 1] == '=') {
-            token = new Token(Symbol::GREATER_EQ);
+        if (position + 1 < bufferLength && buffer[position + 1] == '=') {
+            symbol = Symbol::GREATER_EQ;
             position++;
         }
-        else token = new Token(Symbol::GREATER);
+        else symbol = Symbol::GREATER;
         break;
     case '<':
-        if (buffer[position + 1] == '=') {
-            token = new Token(Symbol::LESS_EQ);
+        if (position + 1 < bufferLength && buffer[position + 1] == '=') {
+            symbol = Symbol::LESS_EQ;
             position++;
         }
-        else token = new Token(Symbol::LESS);
+        else symbol = Symbol::LESS;
         break;
     case '#':
-        if (buffer[position + 1] == 't') {
-            token = new Token(Symbol::SHARP_T);
+        if (position + 1 < bufferLength && (buffer[position + 1] == 't' || buffer[position + 1] == 'T')) {
+            symbol = Symbol::SHARP_T;
             position++;
         }
         else notifyError("#t variable expected");
         break;
+    default:
+        isSymbol = false;
     }
-    if (token != nullptr) {
+    float value;
+    if (isSymbol) {
         position++;
-        float value;
-        if (matchNumber(&value)) token = new Token(-value);
+        if (matchNumber(&value)) return addToken(Token(-value));
+        return addToken(Token(symbol));
     }
-    else {
-        float value;
-        if (matchNumber(&value)) token = new Token(value);
-        else {
-            int start = position++;
-            while (position < bufferLength &&
-                ((buffer[position] >= 'a' && buffer[position] <= 'z') ||
-                    (buffer[position] >= '0' && buffer[position] <= '9') ||
-                    buffer[position] == '-' || buffer[position] == '_'))
-                position++;
-            string description(&buffer[start], position - start);
-            if (description.at(0) == '?') token = new Token(Symbol::VARIABLE, description);
-            else {
-                unordered_map<string, Symbol>::const_iterator index = symbols.find(description);
-                if (index == symbols.end()) {
-                    token = new Token(Symbol::NAME, description);
-                }
-                else {
-                    token = new Token(index->second, description);
-                }
-            }
+    if (matchNumber(&value)) return addToken(Token(value));
+    // Name, variable or keyword (the first character is always taken)
+    int start = position;
+    bool capitals = buffer[start] >= 'A' && buffer[start] <= 'Z';
+    position = ScanKernels::skipName(buffer, start + 1, bufferLength, capitals);
+    TokenText description = foldName(start, position - start, capitals);
+    unsigned int id = readOnlySymbols ? symbolTable->find(description.data(), description.length())
+        : symbolTable->intern(description.data(), description.length());
+    if (description.at(0) == '?') return addToken(Token(Symbol::VARIABLE, description, id));
+    return addToken(Token(keywordSymbol(description.data(), description.length()), description, id));
+}
+
+// Returns the symbol of a keyword (symbolNames), or NAME if the given lowercase name is
+// not a keyword. Compiled into a switch on the length and first character, so it needs
+// no table and no memory allocation
+Symbol SyntaxAnalyzer::keywordSymbol(const char* name, int length) {
+    switch (length) {
+    case 2:
+        switch (name[0]) {
+        case 'a': return memcmp(name + 1, "t", 1) == 0 ? Symbol::AT : Symbol::NAME;
+        case 'o': return memcmp(name + 1, "r", 1) == 0 ? Symbol::OR : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 3:
+        switch (name[0]) {
+        case 'a':
+            if (memcmp(name + 1, "nd", 2) == 0) return Symbol::AND;
+            if (memcmp(name + 1, "ll", 2) == 0) return Symbol::ALL;
+            return Symbol::NAME;
+        case 'e': return memcmp(name + 1, "nd", 2) == 0 ? Symbol::END : Symbol::NAME;
+        case 'n': return memcmp(name + 1, "ot", 2) == 0 ? Symbol::NOT : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 4:
+        switch (name[0]) {
+        case 'g': return memcmp(name + 1, "oal", 3) == 0 ? Symbol::GOAL : Symbol::NAME;
+        case 'i': return memcmp(name + 1, "nit", 3) == 0 ? Symbol::INIT : Symbol::NAME;
+        case 'o': return memcmp(name + 1, "ver", 3) == 0 ? Symbol::OVER : Symbol::NAME;
+        case 'w': return memcmp(name + 1, "hen", 3) == 0 ? Symbol::WHEN : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 5:
+        switch (name[0]) {
+        case 'i': return memcmp(name + 1, "mply", 4) == 0 ? Symbol::IMPLY : Symbol::NAME;
+        case 's': return memcmp(name + 1, "tart", 4) == 0 ? Symbol::START : Symbol::NAME;
+        case 't': return memcmp(name + 1, "ypes", 4) == 0 ? Symbol::TYPES : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 6:
+        switch (name[0]) {
+        case 'a':
+            if (memcmp(name + 1, "ction", 5) == 0) return Symbol::ACTION;
+            if (memcmp(name + 1, "ssign", 5) == 0) return Symbol::ASSIGN;
+            if (memcmp(name + 1, "lways", 5) == 0) return Symbol::ALWAYS;
+            return Symbol::NAME;
+        case 'd':
+            if (memcmp(name + 1, "efine", 5) == 0) return Symbol::DEFINE;
+            if (memcmp(name + 1, "omain", 5) == 0) return Symbol::PDDLDOMAIN;
+            return Symbol::NAME;
+        case 'e':
+            if (memcmp(name + 1, "ither", 5) == 0) return Symbol::EITHER;
+            if (memcmp(name + 1, "ffect", 5) == 0) return Symbol::EFFECT;
+            if (memcmp(name + 1, "xists", 5) == 0) return Symbol::EXISTS;
+            return Symbol::NAME;
+        case 'f': return memcmp(name + 1, "orall", 5) == 0 ? Symbol::FORALL : Symbol::NAME;
+        case 'l': return memcmp(name + 1, "ength", 5) == 0 ? Symbol::LENGTH : Symbol::NAME;
+        case 'm': return memcmp(name + 1, "etric", 5) == 0 ? Symbol::METRIC : Symbol::NAME;
+        case 'n': return memcmp(name + 1, "umber", 5) == 0 ? Symbol::NUMBER_TYPE : Symbol::NAME;
+        case 'w': return memcmp(name + 1, "ithin", 5) == 0 ? Symbol::WITHIN : Symbol::NAME;
+        default: return Symbol::NAME;
         }
+    case 7:
+        switch (name[0]) {
+        case 'c': return memcmp(name + 1, "ontrol", 6) == 0 ? Symbol::CONTROL : Symbol::NAME;
+        case 'd': return memcmp(name + 1, "erived", 6) == 0 ? Symbol::DERIVED : Symbol::NAME;
+        case 'i': return memcmp(name + 1, "nteger", 6) == 0 ? Symbol::INTEGER_TYPE : Symbol::NAME;
+        case 'o': return memcmp(name + 1, "bjects", 6) == 0 ? Symbol::OBJECTS : Symbol::NAME;
+        case 'p': return memcmp(name + 1, "roblem", 6) == 0 ? Symbol::PROBLEM : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 8:
+        switch (name[0]) {
+        case 'd':
+            if (memcmp(name + 1, "ecrease", 7) == 0) return Symbol::DECREASE;
+            if (memcmp(name + 1, "uration", 7) == 0) return Symbol::DURATION;
+            return Symbol::NAME;
+        case 'i': return memcmp(name + 1, "ncrease", 7) == 0 ? Symbol::INCREASE : Symbol::NAME;
+        case 'm':
+            if (memcmp(name + 1, "aximize", 7) == 0) return Symbol::MAXIMIZE;
+            if (memcmp(name + 1, "inimize", 7) == 0) return Symbol::MINIMIZE;
+            return Symbol::NAME;
+        case 's':
+            if (memcmp(name + 1, "cale-up", 7) == 0) return Symbol::SCALE_UP;
+            if (memcmp(name + 1, "ometime", 7) == 0) return Symbol::SOMETIME;
+            return Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 9:
+        switch (name[0]) {
+        case 'c':
+            if (memcmp(name + 1, "onstants", 8) == 0) return Symbol::CONSTANTS;
+            if (memcmp(name + 1, "ondition", 8) == 0) return Symbol::CONDITION;
+            return Symbol::NAME;
+        case 'f': return memcmp(name + 1, "unctions", 8) == 0 ? Symbol::FUNCTIONS : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 10:
+        switch (name[0]) {
+        case 'h': return memcmp(name + 1, "old-after", 9) == 0 ? Symbol::HOLD_AFTER : Symbol::NAME;
+        case 'p':
+            if (memcmp(name + 1, "redicates", 9) == 0) return Symbol::PREDICATES;
+            if (memcmp(name + 1, "arameters", 9) == 0) return Symbol::PARAMETERS;
+            if (memcmp(name + 1, "reference", 9) == 0) return Symbol::PREFERENCE;
+            return Symbol::NAME;
+        case 's': return memcmp(name + 1, "cale-down", 9) == 0 ? Symbol::SCALE_DOWN : Symbol::NAME;
+        case 't': return memcmp(name + 1, "otal-time", 9) == 0 ? Symbol::TOTAL_TIME : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 11:
+        switch (name[0]) {
+        case 'c': return memcmp(name + 1, "onstraints", 10) == 0 ? Symbol::CONSTRAINTS : Symbol::NAME;
+        case 'h': return memcmp(name + 1, "old-during", 10) == 0 ? Symbol::HOLD_DURING : Symbol::NAME;
+        case 'i': return memcmp(name + 1, "s-violated", 10) == 0 ? Symbol::IS_VIOLATED : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 12:
+        switch (name[0]) {
+        case 'a': return memcmp(name + 1, "t-most-once", 11) == 0 ? Symbol::AT_MOST_ONCE : Symbol::NAME;
+        case 'p': return memcmp(name + 1, "recondition", 11) == 0 ? Symbol::PRECONDITION : Symbol::NAME;
+        case 'r': return memcmp(name + 1, "equirements", 11) == 0 ? Symbol::REQUIREMENTS : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 13:
+        switch (name[0]) {
+        case 'a': return memcmp(name + 1, "lways-within", 12) == 0 ? Symbol::ALWAYS_WITHIN : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 14:
+        switch (name[0]) {
+        case 's': return memcmp(name + 1, "ometime-after", 13) == 0 ? Symbol::SOMETIME_AFTER : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    case 15:
+        switch (name[0]) {
+        case 'd': return memcmp(name + 1, "urative-action", 14) == 0 ? Symbol::DURATIVE_ACTION : Symbol::NAME;
+        case 's': return memcmp(name + 1, "ometime-before", 14) == 0 ? Symbol::SOMETIME_BEFORE : Symbol::NAME;
+        default: return Symbol::NAME;
+        }
+    default: return Symbol::NAME;
     }
-    return token;
+}
+
+// Stores a token in the window of recent tokens, replacing the oldest one
+Token* SyntaxAnalyzer::addToken(const Token& token) {
+    Token* slot = &tokens[tokenCount & (tokenWindowSize - 1)];
+    *slot = token;
+    tokenCount++;
+    return slot;
+}
+
+// Returns the text of a name, lowercased (PDDL is case-insensitive). The input buffer
+// is read-only, so names with capital letters are copied into the text of the token
+// slot. Names of streamed inputs are always copied, as their chunk is reused
+TokenText SyntaxAnalyzer::foldName(int start, int length, bool capitals) {
+    const char* name = &buffer[start];
+    if (!capitals && ownedBuffer == nullptr) return TokenText(name, length);
+    string& text = texts[tokenCount & (tokenWindowSize - 1)];
+    text.assign(name, length);
+    if (capitals) {
+        for (int i = 0; i < length; i++)
+            if (text[i] >= 'A' && text[i] <= 'Z') text[i] += 'a' - 'A';
+    }
+    return TokenText(text.data(), length);
 }
 
 // Checks if the next token is a number
@@ -194,10 +562,9 @@ bool SyntaxAnalyzer::matchNumber(float* value) {
 
 // Skips the spaces in the text
 void SyntaxAnalyzer::skipSpaces() {
-    while (position < bufferLength && buffer[position] <= ' ') {
-        if (buffer[position] == '\n') lineNumber++;
-        position++;
-    }
+    do {
+        position = ScanKernels::skipSpaces(buffer, position, bufferLength, lineNumber);
+    } while (position == bufferLength && fillBuffer());
 }
 
 // Reads an open parenthesis
@@ -223,9 +590,7 @@ void SyntaxAnalyzer::readColon() {
 
 // Raises a parse error
 void SyntaxAnalyzer::notifyError(const std::string& msg) {
-    cout << "Error in file " << fileName << " (line " << lineNumber << ")" << endl;
-    cout << msg << endl;
-    exit(2);
+    throw ParseError(2, "Error in file " + string(fileName) + " (line " + to_string(lineNumber) + ")\n" + msg);
 }
 
 // Returns the next token if its type is equal to the given one
@@ -252,10 +617,15 @@ Token* SyntaxAnalyzer::readSymbol(int numSymbols, ...) {
 
 // Returns the description of the next token if it is a name
 string SyntaxAnalyzer::readName() {
+    return readNameToken()->description;
+}
+
+// Returns the next token if it is a name
+Token* SyntaxAnalyzer::readNameToken() {
     Token* res = nextToken();
     if (!isSym(res, Symbol::NAME) && !isSym(res, Symbol::AT) && !isSym(res, Symbol::OVER)
         && !isSym(res, Symbol::OBJECTS) && !isSym(res, Symbol::CONSTRAINTS)) {
         notifyError("Name expected, but token '" + res->toString() + "' found");
     }
-    return res->description;
+    return res;
 }
@@ -2,7 +2,9 @@
 #define SYNTAXANALYZER_H
 #include <string>
 #include <vector>
-#include <unordered_map>
+#include <stdexcept>
+#include "symbolTable.h"
+#include "decompressor.h"
 
 /********************************************************/
 /* Oscar Sapena Vercher - DSIC - UPV                    */
@@ -54,32 +56,93 @@ const char* const symbolDescriptions[] = {"name", "variable", "number", "define"
       "metric", "maximize", "minimize", "total-time", "is-violated", "duration",
       "control", "integer"};
 
+// Text of a token. Refers to a range of the input buffer (or of the buffer of folded
+// names of the analyzer) instead of owning a copy
+class TokenText {
+private:
+    const char* text;
+    int len;
+public:
+    TokenText() : text(""), len(0) { }
+    TokenText(const char* text, int length) : text(text), len(length) { }
+    inline const char* data() const { return text; }
+    inline int length() const { return len; }
+    inline char at(int index) const { return text[index]; }
+    inline std::string str() const { return std::string(text, len); }
+    inline operator std::string() const { return str(); }
+    inline int compare(const std::string& s) const { return -s.compare(0, s.length(), text, len); }
+    inline int compare(const char* s) const { return compare(std::string(s)); }
+};
+
+inline std::string operator+(const std::string& s, const TokenText& t) { return s + t.str(); }
+inline std::string operator+(const char* s, const TokenText& t) { return s + t.str(); }
+inline std::string operator+(std::string&& s, const TokenText& t) { return s.append(t.data(), t.length()); }
+
 class Token {
 public:
       Symbol symbol;
-      std::string description;
+      TokenText description;
+      unsigned int id;      // Identifier of the text in the symbol table (names, variables and keywords)
       float value;
       Token(Symbol s);
       Token(float v);
-      Token(Symbol s, std::string const &desc);
+      Token(Symbol s, const TokenText& desc, unsigned int id);
       std::string toString();
 };
 
+// Error found while reading a file. The code is the exit code of the program
+// (1: file not found, 2: syntax error)
+class ParseError : public std::runtime_error {
+public:
+    int code;
+    ParseError(int code, const std::string& msg) : std::runtime_error(msg), code(code) { }
+};
+
+// Range of the input text, with the line number of its first character
+struct TextChunk {
+    int start;
+    int end;
+    int line;
+};
+
+// Number of recent tokens kept by the syntactic analyzer (power of two). A token (and
+// its text) is only valid until this number of new tokens have been read
+const int tokenWindowSize = 16;
+
 class SyntaxAnalyzer {
 private:
-    char* fileName;
-    char* buffer;
+    const char* fileName;
+    const char* buffer;     // Input text, not case-folded (names are lowercased while scanning)
+    char* ownedBuffer;      // Chunk of the input when it cannot be memory-mapped (pipes, stdin)
+    int bufferCapacity;     // Size of the owned buffer
+    int input;              // Descriptor of the streamed input (-1 if mapped or fully read)
+    Decompressor* decompressor; // Decoder of the streamed input if it is compressed
+    size_t mappedLength;    // Length of the memory-mapped file (0 if not mapped)
     int lineNumber;
     int position;
     int bufferLength;
-    std::vector<Token*> tokens;
-    std::unordered_map<std::string, Symbol> symbols;
+    std::vector<Token> tokens;          // Ring buffer with the last tokens read
+    std::string texts[tokenWindowSize]; // Copies of the token texts that cannot refer to the input
+    long tokenCount;                    // Number of tokens read
+    long chunkTokenCount;               // Number of tokens read by the analyzers of chunks
+    SymbolTable* symbolTable;           // Shared with the parsed task
+    bool readOnlySymbols;               // Names are looked up instead of interned (chunks read in parallel)
     void skipSpaces();
+    void skipBlanks();
     Token* matchToken();
+    Token* addToken(const Token& token);
+    TokenText foldName(int start, int length, bool capitals);
+    static Symbol keywordSymbol(const char* name, int length);
     bool matchNumber(float *value);
+    bool fillBuffer();
+    void detectCompression();
+    void completeToken();
+    void initialize();
 public:
     int tokenIndex;
-    SyntaxAnalyzer(char* fileName);
+    SyntaxAnalyzer(char* fileName, SymbolTable* symbolTable);
+    SyntaxAnalyzer(const char* name, const char* contents, size_t length, SymbolTable* symbolTable);
+    SyntaxAnalyzer(const SyntaxAnalyzer& parent, const TextChunk& chunk);
     ~SyntaxAnalyzer();
     Token* nextToken();
     Token* readSymbol(Symbol s);
@@ -88,6 +151,11 @@ public:
     void closePar();
     void readColon();
     std::string readName();
+    Token* readNameToken();
+    bool splitList(int maxChunks, int minChunkSize, std::vector<TextChunk>& chunks);
+    bool endOfInput();
+    inline long numTokens() { return tokenCount + chunkTokenCount; }
+    inline void countChunkTokens(long n) { chunkTokenCount += n; }
     void notifyError(const std::string &msg);
     // Checks whether the token is the given type
     inline bool isSym(Token* token, Symbol s) {
@@ -102,7 +170,10 @@ public:
         } else return false;
     }
     // Reuses the last token
-    inline void undoToken() { tokenIndex--; }
+    inline void undoToken() {
+        if (-tokenIndex >= tokenWindowSize) notifyError("Too many tokens undone");
+        tokenIndex--;
+    }
 };
 
 #endif
@@ -7,21 +7,45 @@
 /********************************************************/
 
 #include <iostream>
+#include <fstream>
 #include <string.h>
+#include <thread>
 #include "parser/parser.h"
 #include "parser/parsedTask.h"
 #include "preprocess/preprocess.h"
+#include "preprocess/taskSnapshot.h"
 #include "stages/task.h"
 #include "stages/stages.h"
+#include "stages/classifier.h"
+#include "server/classificationServer.h"
+#include "utils/profiler.h"
 
 using namespace std;
 
 // Prints the command-line arguments of the planner
 void printUsage() {
     cout << "Usage to extract stages:" << endl;
-    cout << "\tplanFeatExtractor <domain_file>" << endl;
+    cout << "\tplanFeatExtractor [options] <domain_file>" << endl;
     cout << "Usage to classify problem objects:" << endl;
-    cout << "\tplanFeatExtractor <domain_file> <problem_file>" << endl;
+    cout << "\tplanFeatExtractor [options] <domain_file> <problem_file>" << endl;
+    cout << "Usage to classify the objects of several problems of the same domain:" << endl;
+    cout << "\tplanFeatExtractor [options] --batch <domain_file> <problem_list_file>" << endl;
+    cout << "\t(the list file contains a problem file name per line)" << endl;
+    cout << "Usage to start a classification server:" << endl;
+    cout << "\tplanFeatExtractor [options] --server <socket_path> <domain_file> [<domain_file> ...]" << endl;
+    cout << "Usage to compute the stages of a previously saved task:" << endl;
+    cout << "\tplanFeatExtractor [options] --load-snapshot <snapshot_file>" << endl;
+    cout << "A domain or problem file name '-' reads that file from the standard input." << endl;
+    cout << "Options:" << endl;
+    cout << "\t--threads N\tNumber of threads (0 = all cores). In batch mode the problems are classified in parallel" << endl;
+    cout << "\t\t(default 1); otherwise large :init sections and the actions of large domains are processed" << endl;
+    cout << "\t\tin parallel (default 1 in server mode, as the clients are attended in parallel, and 0 otherwise)" << endl;
+    cout << "\t--cache <dir>\tLoads/saves the domain analysis from/to the given directory" << endl;
+    cout << "\t--dump-snapshot <file>\tSaves the preprocessed task in a binary snapshot file" << endl;
+    cout << "\t\t(not valid with --batch, --server, --cache or --load-snapshot)" << endl;
+    cout << "\t--max-operators N\tMaximum number of operators generated from each action (default 0 = no limit)" << endl;
+    cout << "\t--profile\tPrints the time, peak memory growth and item counts of each phase to stderr" << endl;
+    cout << "\t--profile-file <file>\tWrites the profiling report to the given file in JSON format" << endl;
 }
 
 // Parses the domain and problem files
@@ -51,23 +75,146 @@ void computeStages(PreprocessedTask* prepTask, bool classify) {
     }
 }
 
+// Classifies the objects of every problem in the list file. The domain is analysed
+// only once and a JSON document (or an error message) is printed for each problem, in
+// the list order. Returns the error code of the first problem that failed, or 0
+int batchStage(char* domainFileName, char* problemListFileName, int numThreads, char* cacheDir) {
+    ifstream listFile(problemListFileName);
+    if (!listFile.is_open()) {
+        throw ParseError(1, "File not found: " + string(problemListFileName));
+    }
+    vector<string> problemFileNames;
+    string line;
+    while (getline(listFile, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos) continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        problemFileNames.push_back(line.substr(start, end - start + 1));
+    }
+    if (numThreads <= 0) numThreads = (int)thread::hardware_concurrency();
+    Classifier classifier(domainFileName, cacheDir);
+    return classifier.classify(problemFileNames, numThreads, cout);
+}
+
+// Loads the domains and answers the classification requests received through the socket.
+// Returns a non-zero error code if the server cannot be started
+int serverStage(char* socketPath, int numDomains, char* domainFileNames[], char* cacheDir) {
+    ClassificationServer server(socketPath);
+    for (int i = 0; i < numDomains; i++) {
+        server.addDomain(domainFileNames[i], cacheDir);
+    }
+    return server.run() ? 0 : 1;
+}
+
+// Computes the stages, or classifies the objects of the problem, loading the domain analysis
+// from the cache directory if possible
+void cachedStage(char* domainFileName, char* problemFileName, char* cacheDir) {
+    Classifier classifier(domainFileName, cacheDir);
+    if (problemFileName != NULL) {
+        classifier.classify(problemFileName, cout);
+    }
+    else {
+        classifier.toJSON();
+    }
+}
+
+// Computes the stages, or classifies the objects if the saved task includes a problem,
+// loading the preprocessed task from a snapshot file
+void snapshotStage(char* snapshotFileName) {
+    PreprocessedTask* prepTask = TaskSnapshot::load(snapshotFileName);
+    ParsedTask* parsedTask = prepTask->task;
+    computeStages(prepTask, !parsedTask->problemName.empty());
+    delete prepTask;
+    delete parsedTask;
+}
+
 // Main method
 int main(int argc, char* argv[]) {
-    if (argc != 2 && argc != 3) {
-       printUsage();
-    } else {
-        char* domainFileName = argv[1];
-        char* problemFileName = argc == 3 ? argv[2] : NULL;
-        
-        ParsedTask* parsedTask = parseStage(domainFileName, problemFileName);
-        if (parsedTask != nullptr) {
-            PreprocessedTask* prepTask = preprocessStage(parsedTask);
-            if (prepTask != nullptr) {
-                computeStages(prepTask, problemFileName != NULL);
-                delete prepTask;
+    bool batch = false, server = false, validArgs = true;
+    int numThreads = -1;
+    char* cacheDir = NULL;
+    char* profileFileName = NULL;
+    char* dumpSnapshot = NULL;
+    char* loadSnapshot = NULL;
+    int arg = 1;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (strcmp(argv[arg], "--batch") == 0) batch = true;
+        else if (strcmp(argv[arg], "--server") == 0) server = true;
+        else if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc) numThreads = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc) cacheDir = argv[++arg];
+        else if (strcmp(argv[arg], "--dump-snapshot") == 0 && arg + 1 < argc) dumpSnapshot = argv[++arg];
+        else if (strcmp(argv[arg], "--load-snapshot") == 0 && arg + 1 < argc) loadSnapshot = argv[++arg];
+        else if (strcmp(argv[arg], "--max-operators") == 0 && arg + 1 < argc)
+            Preprocess::setMaxOperatorsPerAction(atoi(argv[++arg]));
+        else if (strcmp(argv[arg], "--profile") == 0) Profiler::enable();
+        else if (strcmp(argv[arg], "--profile-file") == 0 && arg + 1 < argc) {
+            profileFileName = argv[++arg];
+            Profiler::enable();
+        }
+        else validArgs = false;
+        arg++;
+    }
+    int numArgs = argc - arg;
+    int exitCode = 0;
+    if (batch) {        // Each problem is processed by a single thread, as there are several in parallel
+        Parser::setMaxThreads(1);
+        Preprocess::setMaxThreads(1);
+        if (numThreads < 0) numThreads = 1;
+    }
+    else if (server && numThreads < 0) {     // Each client is attended by its own thread
+        Parser::setMaxThreads(1);
+        Preprocess::setMaxThreads(1);
+    }
+    else if (numThreads >= 0) {
+        Parser::setMaxThreads(numThreads);
+        Preprocess::setMaxThreads(numThreads);
+    }
+    {
+        ProfileScope profile("total");
+        try {
+            if (!validArgs || (batch && server) ||
+                (dumpSnapshot != NULL && (batch || server || cacheDir != NULL || loadSnapshot != NULL))) {
+                printUsage();
+            } else if (loadSnapshot != NULL) {
+                if (numArgs == 0 && !batch && !server) snapshotStage(loadSnapshot);
+                else printUsage();
+            } else if (batch) {
+                if (numArgs == 2) exitCode = batchStage(argv[arg], argv[arg + 1], numThreads, cacheDir);
+                else printUsage();
+            } else if (server) {
+                if (numArgs >= 2) exitCode = serverStage(argv[arg], numArgs - 1, argv + arg + 1, cacheDir);
+                else printUsage();
+            } else if (numArgs != 1 && numArgs != 2) {
+               printUsage();
+            } else if (cacheDir != NULL) {
+                cachedStage(argv[arg], numArgs == 2 ? argv[arg + 1] : NULL, cacheDir);
+            } else {
+                char* domainFileName = argv[arg];
+                char* problemFileName = numArgs == 2 ? argv[arg + 1] : NULL;
+                
+                ParsedTask* parsedTask = parseStage(domainFileName, problemFileName);
+                if (parsedTask != nullptr) {
+                    PreprocessedTask* prepTask = preprocessStage(parsedTask);
+                    if (prepTask != nullptr) {
+                        if (dumpSnapshot != NULL) TaskSnapshot::save(prepTask, dumpSnapshot);
+                        computeStages(prepTask, problemFileName != NULL);
+                        delete prepTask;
+                    }
+                    delete parsedTask;
+                }
             }
-            delete parsedTask;
         }
+        catch (ParseError& e) {
+            cout << e.what() << endl;
+            exitCode = e.code;
+        }
+    }
+    if (Profiler::isEnabled()) {
+        if (profileFileName != NULL) {
+            ofstream profileFile(profileFileName);
+            Profiler::toJSON(profileFile);
+        }
+        else Profiler::report(cerr);
     }
-    return 0;
+    return exitCode;
 }
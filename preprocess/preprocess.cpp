@@ -9,11 +9,32 @@
 
 #include "preprocess.h"
 #include "../utils/utils.h"
+#include "../utils/profiler.h"
+#include "../utils/workStealingPool.h"
 #include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <exception>
 using namespace std;
 
+// Maximum number of operators generated from each action (0 = no limit)
+unsigned int Preprocess::maxOperatorsPerAction = 0;
+
+// Maximum number of threads to preprocess the actions (0 = all cores)
+unsigned int Preprocess::maxThreads = 0;
+
+// Minimum number of actions to preprocess them in parallel
+const unsigned int minParallelActions = 16;
+
 // Creates a new preprocessor
 Preprocess::Preprocess() {
+    objectsByType = nullptr;
+    opParameters = nullptr;
+    opControlVars = nullptr;
+    remainingOperators = 0;
+    operatorsTruncated = false;
+    truncatedActions = 0;
 }
 
 // Disposes the preprocessor
@@ -22,27 +43,120 @@ Preprocess::~Preprocess() {
 
 // Starts the preprocess and returns the preprocessed task
 PreprocessedTask* Preprocess::preprocessTask(ParsedTask* parsedTask) {
+    ProfileScope profile("preprocess");
     task = parsedTask;
+    objectsByType = nullptr;
+    truncatedActions = 0;
     prepTask = new PreprocessedTask(parsedTask);
     preprocessOperators();
+    profile.count("operators", prepTask->operators.size());
+    if (truncatedActions > 0) profile.count("truncatedActions", truncatedActions);
     //cout << prepTask->toString() << endl;
     return prepTask;
 }
 
-// Operators preprocessing
-void Preprocess::preprocessOperators() {
-    for (unsigned int i = 0; i < task->actions.size(); i++) {
+// Preprocesses only the problem goal. Used when the domain operators have already been
+// preprocessed and only the problem data is needed
+PreprocessedTask* Preprocess::preprocessProblemGoal(ParsedTask* parsedTask) {
+    ProfileScope profile("preprocessGoal");
+    task = parsedTask;
+    objectsByType = nullptr;
+    truncatedActions = 0;
+    prepTask = new PreprocessedTask(parsedTask);
+    preprocessGoal();
+    profile.count("operators", prepTask->operators.size());
+    return prepTask;
+}
+
+// Checks if the preprocessed operators depend on the problem objects, i.e. if there are
+// quantifiers in the actions, since they are replaced by the matching task objects
+bool Preprocess::objectDependentOperators(ParsedTask* parsedTask) {
+    for (unsigned int i = 0; i < parsedTask->actions.size(); i++) {
         FeatureList features = { }; // Initialize to zero
-        checkPreconditionFeatures(task->actions[i].precondition, &features);
-        checkEffectFeatures(task->actions[i].effect, &features);
-        preprocessAction(task->actions[i], &features, false);
+        checkPreconditionFeatures(parsedTask->actions[i].precondition, &features);
+        checkEffectFeatures(parsedTask->actions[i].effect, &features);
+        if (features.universalQuantifierPrec > 0 || features.existentialQuantifierPrec > 0 ||
+            features.universalQuantifierEff > 0 || features.existentialQuantifierEff > 0)
+            return true;
     }
-    for (unsigned int i = 0; i < task->durativeActions.size(); i++) {
+    for (unsigned int i = 0; i < parsedTask->durativeActions.size(); i++) {
         FeatureList features = { }; // Initialize to zero
-        checkPreconditionFeatures(task->durativeActions[i].condition, &features);
-        checkEffectFeatures(task->durativeActions[i].effect, &features);
-        preprocessAction(task->durativeActions[i], &features, false);
+        checkPreconditionFeatures(parsedTask->durativeActions[i].condition, &features);
+        checkEffectFeatures(parsedTask->durativeActions[i].effect, &features);
+        if (features.universalQuantifierPrec > 0 || features.existentialQuantifierPrec > 0 ||
+            features.universalQuantifierEff > 0 || features.existentialQuantifierEff > 0)
+            return true;
+    }
+    return false;
+}
+
+// Operators preprocessing. Actions are independent, so if there are many of them they are
+// preprocessed in parallel by separate workers and their operators are then appended to the
+// task in the order of the actions
+void Preprocess::preprocessOperators() {
+    unsigned int numActions = task->actions.size() + task->durativeActions.size();
+    int numThreads = maxThreads > 0 ? (int)maxThreads : (int)thread::hardware_concurrency();
+    if (numThreads < 2 || numActions < minParallelActions) {
+        for (unsigned int i = 0; i < numActions; i++)
+            preprocessAction(i);
+    } else {
+        if (objectDependentOperators(task)) buildObjectIndex();    // Shared by the workers
+        vector<PreprocessedTask> results(numActions, PreprocessedTask(task));
+        vector<unsigned int> truncated(numActions);
+        vector<exception_ptr> errors(numActions);
+        {
+            WorkStealingPool pool(numThreads);
+            pool.start(numActions, [&](int i) {
+                Preprocess worker;
+                worker.task = task;
+                worker.prepTask = &results[i];
+                worker.objectsByType = objectsByType;
+                try {
+                    worker.preprocessAction(i);
+                }
+                catch (...) {       // Rethrown by the calling thread
+                    errors[i] = current_exception();
+                }
+                truncated[i] = worker.truncatedActions;
+            });
+            pool.wait();
+        }
+        for (unsigned int i = 0; i < numActions; i++) {
+            if (errors[i] != nullptr) rethrow_exception(errors[i]);
+        }
+        size_t numOperators = prepTask->operators.size();
+        for (unsigned int i = 0; i < numActions; i++)
+            numOperators += results[i].operators.size();
+        prepTask->operators.reserve(numOperators);
+        for (unsigned int i = 0; i < numActions; i++) {
+            vector<Operator>& operators = results[i].operators;
+            prepTask->operators.insert(prepTask->operators.end(),
+                make_move_iterator(operators.begin()), make_move_iterator(operators.end()));
+            truncatedActions += truncated[i];
+        }
+    }
+    preprocessGoal();
+}
+
+// Preprocesses an action. Durative actions are numbered after the rest of actions
+void Preprocess::preprocessAction(unsigned int index) {
+    FeatureList features = { }; // Initialize to zero
+    if (index < task->actions.size()) {
+        checkPreconditionFeatures(task->actions[index].precondition, &features);
+        checkEffectFeatures(task->actions[index].effect, &features);
+        Action a = task->actions[index];    // The parsed task is not modified
+        preprocessAction(a, &features, false);
+    } else {
+        index -= task->actions.size();
+        checkPreconditionFeatures(task->durativeActions[index].condition, &features);
+        checkEffectFeatures(task->durativeActions[index].effect, &features);
+        DurativeAction a = task->durativeActions[index];
+        preprocessAction(a, &features, false);
     }
+}
+
+// Goal preprocessing: the goal is stored as a special operator
+void Preprocess::preprocessGoal() {
     Action goalAction;
     goalAction.index = -1;
     goalAction.name = "#goal";
@@ -196,8 +310,11 @@ void Preprocess::checkGoalFeatures(DurativeCondition &goal, FeatureList* feature
     }
 }
     
-// Processes an action and stores the result in a vector of simplified operators
-void Preprocess::preprocessAction(Action a, FeatureList* features, bool isGoal) {
+// Processes an action and stores the result in a vector of simplified operators. If there is a
+// limit of operators per action, it is shared by all the actions obtained from the conditional effects
+void Preprocess::preprocessAction(Action &a, FeatureList* features, bool isGoal) {
+    remainingOperators = maxOperatorsPerAction;
+    operatorsTruncated = false;
     if (features->universalQuantifierPrec > 0 || features->existentialQuantifierPrec > 0)
         removeQuantifiers(a.precondition, a.parameters.size());
     if (features->universalQuantifierEff > 0 || features->existentialQuantifierEff > 0)
@@ -208,18 +325,22 @@ void Preprocess::preprocessAction(Action a, FeatureList* features, bool isGoal)
         removeImplications(a.effect);
     preconditionOptimization(&a.precondition, nullptr, 0, a);
     effectOptimization(&a.effect, nullptr, 0, a);
-    vector<Action> aList;
     if (features->conditionalEff > 0) {
+        vector<Action> aList;
         removeConditionalEffects(a, aList);
+        for (unsigned int i = 0; i < aList.size(); i++)
+            buildOperators(aList[i], isGoal);
     } else {
-        aList.push_back(a);
+        buildOperators(a, isGoal);
     }
-    for (unsigned int i = 0; i < aList.size(); i++)
-        buildOperators(aList[i], isGoal);
+    if (operatorsTruncated) truncatedActions++;
 }
 
-// Processes a durative action and stores the result in a vector of simplified operators
-void Preprocess::preprocessAction(DurativeAction a, FeatureList* features, bool isGoal) {
+// Processes a durative action and stores the result in a vector of simplified operators. If there is a
+// limit of operators per action, it is shared by all the actions obtained from the conditional effects
+void Preprocess::preprocessAction(DurativeAction &a, FeatureList* features, bool isGoal) {
+    remainingOperators = maxOperatorsPerAction;
+    operatorsTruncated = false;
     if (features->universalQuantifierPrec > 0 || features->existentialQuantifierPrec > 0)
         removeQuantifiers(a.condition, a.parameters.size());
     if (features->universalQuantifierEff > 0 || features->existentialQuantifierEff > 0)
@@ -230,14 +351,15 @@ void Preprocess::preprocessAction(DurativeAction a, FeatureList* features, bool
         removeImplications(a.effect);
     preconditionOptimization(&a.condition, nullptr, 0, a);
     effectOptimization(&a.effect, nullptr, 0, a);
-    vector<DurativeAction> aList;
     if (features->conditionalEff > 0) {
+        vector<DurativeAction> aList;
         removeConditionalEffects(a, aList);
+        for (unsigned int i = 0; i < aList.size(); i++)
+            buildOperators(aList[i], isGoal);
     } else {
-        aList.push_back(a);
+        buildOperators(a, isGoal);
     }
-    for (unsigned int i = 0; i < aList.size(); i++)
-        buildOperators(aList[i], isGoal);
+    if (operatorsTruncated) truncatedActions++;
 }
     
 // Removes all quantifiers from a precondition
@@ -250,21 +372,28 @@ void Preprocess::removeQuantifiers(Precondition &prec, unsigned int numParameter
         break;
     case PT_NOT:
         removeQuantifiers(prec.terms[0], numParameters);
+        break;
     case PT_IMPLY:
         removeQuantifiers(prec.terms[0], numParameters);
         removeQuantifiers(prec.terms[1], numParameters);
         break;
     case PT_EXISTS:
         prec.type = PT_OR;
-        replaceQuantifierParameter(prec, prec.terms[0], 0, numParameters);
-        prec.terms.erase(prec.terms.begin());
+        {
+            Precondition body = std::move(prec.terms[0]);
+            prec.terms.clear();
+            replaceQuantifierParameter(prec, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < prec.terms.size(); i++)
             removeQuantifiers(prec.terms[i], numParameters + prec.parameters.size());
         break;
     case PT_FORALL:
         prec.type = PT_AND;
-        replaceQuantifierParameter(prec, prec.terms[0], 0, numParameters);
-        prec.terms.erase(prec.terms.begin());
+        {
+            Precondition body = std::move(prec.terms[0]);
+            prec.terms.clear();
+            replaceQuantifierParameter(prec, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < prec.terms.size(); i++)
             removeQuantifiers(prec.terms[i], numParameters + prec.parameters.size());
         break;
@@ -284,8 +413,11 @@ void Preprocess::removeQuantifiers(DurativeCondition &prec, unsigned int numPara
         break;
     case CT_FORALL:
         prec.type = CT_AND;
-        replaceQuantifierParameter(prec, prec.conditions[0], 0, numParameters);
-        prec.conditions.erase(prec.conditions.begin());
+        {
+            DurativeCondition body = std::move(prec.conditions[0]);
+            prec.conditions.clear();
+            replaceQuantifierParameter(prec, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < prec.conditions.size(); i++)
             removeQuantifiers(prec.conditions[i], numParameters + prec.parameters.size());
         break;
@@ -309,8 +441,11 @@ void Preprocess::removeQuantifiers(Effect &eff, unsigned int numParameters) {
         break;
     case ET_FORALL:
         eff.type = ET_AND;
-        replaceQuantifierParameter(eff, eff.terms[0], 0, numParameters);
-        eff.terms.erase(eff.terms.begin());
+        {
+            Effect body = std::move(eff.terms[0]);
+            eff.terms.clear();
+            replaceQuantifierParameter(eff, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < eff.terms.size(); i++)
             removeQuantifiers(eff.terms[i], numParameters + eff.parameters.size());
         break;
@@ -327,8 +462,11 @@ void Preprocess::removeQuantifiers(DurativeEffect &eff, unsigned int numParamete
         break;
     case DET_FORALL:
         eff.type = DET_AND;
-        replaceQuantifierParameter(eff, eff.terms[0], 0, numParameters);
-        eff.terms.erase(eff.terms.begin());
+        {
+            DurativeEffect body = std::move(eff.terms[0]);
+            eff.terms.clear();
+            replaceQuantifierParameter(eff, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < eff.terms.size(); i++)
             removeQuantifiers(eff.terms[i], numParameters + eff.parameters.size());
         break;
@@ -357,15 +495,21 @@ void Preprocess::removeQuantifiers(GoalDescription &goal, unsigned int numParame
         break;
     case GD_EXISTS:
         goal.type = GD_OR;
-        replaceQuantifierParameter(goal, goal.terms[0], 0, numParameters);
-        goal.terms.erase(goal.terms.begin());
+        {
+            GoalDescription body = std::move(goal.terms[0]);
+            goal.terms.clear();
+            replaceQuantifierParameter(goal, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < goal.terms.size(); i++)
             removeQuantifiers(goal.terms[i], numParameters + goal.parameters.size());
         break;
     case GD_FORALL:
         goal.type = GD_AND;
-        replaceQuantifierParameter(goal, goal.terms[0], 0, numParameters);
-        goal.terms.erase(goal.terms.begin());
+        {
+            GoalDescription body = std::move(goal.terms[0]);
+            goal.terms.clear();
+            replaceQuantifierParameter(goal, body, 0, numParameters);
+        }
         for (unsigned int i = 0; i < goal.terms.size(); i++)
             removeQuantifiers(goal.terms[i], numParameters + goal.parameters.size());
         break;
@@ -373,83 +517,124 @@ void Preprocess::removeQuantifiers(GoalDescription &goal, unsigned int numParame
     }
 }
 
+// Builds, for each type, the list of task objects (and constants) compatible with it, i.e. whose
+// types are the given type or one of its descendants. Objects are stored in increasing order
+void Preprocess::buildObjectIndex() {
+    unsigned int numTypes = task->types.size();
+    vector<vector<unsigned int>> ancestors(numTypes);      // Each type and its ancestors
+    for (unsigned int t = 0; t < numTypes; t++) {
+        ancestors[t].push_back(t);
+        for (unsigned int i = 0; i < ancestors[t].size(); i++) {
+            for (unsigned int parent : task->types[ancestors[t][i]].parentTypes) {
+                if (find(ancestors[t].begin(), ancestors[t].end(), parent) == ancestors[t].end())
+                    ancestors[t].push_back(parent);
+            }
+        }
+    }
+    objectIndex.clear();
+    objectIndex.resize(numTypes);
+    objectsByEitherType.clear();
+    vector<unsigned int> objectTypes;
+    for (unsigned int i = 0; i < task->objects.size(); i++) {
+        const vector<unsigned int>& types = task->objects[i].types;
+        if (types.size() == 1) {
+            for (unsigned int t : ancestors[types[0]])
+                objectIndex[t].push_back(i);
+        } else {
+            objectTypes.clear();
+            for (unsigned int type : types)
+                objectTypes.insert(objectTypes.end(), ancestors[type].begin(), ancestors[type].end());
+            sort(objectTypes.begin(), objectTypes.end());
+            objectTypes.erase(unique(objectTypes.begin(), objectTypes.end()), objectTypes.end());
+            for (unsigned int t : objectTypes)
+                objectIndex[t].push_back(i);
+        }
+    }
+    objectsByType = &objectIndex;
+}
+
+// Returns the task objects that can replace a quantified variable. The index is built the
+// first time it is needed, since most tasks have no quantifiers
+const vector<unsigned int>& Preprocess::getCompatibleObjects(const Variable &param) {
+    if (objectsByType == nullptr) buildObjectIndex();
+    if (param.types.size() == 1) return (*objectsByType)[param.types[0]];
+    auto it = objectsByEitherType.find(param.types);
+    if (it != objectsByEitherType.end()) return it->second;
+    vector<unsigned int>& objects = objectsByEitherType[param.types];   // (either t1 t2 ...)
+    for (unsigned int type : param.types)
+        objects.insert(objects.end(), (*objectsByType)[type].begin(), (*objectsByType)[type].end());
+    sort(objects.begin(), objects.end());
+    objects.erase(unique(objects.begin(), objects.end()), objects.end());
+    return objects;
+}
+
 // Replaces the parameters of a quantifier by the task object that matches
-void Preprocess::replaceQuantifierParameter(Precondition &prec, Precondition term, 
+void Preprocess::replaceQuantifierParameter(Precondition &prec, const Precondition &term, 
         unsigned int paramNumber, unsigned int numParameters) {
     Variable &param = prec.parameters[paramNumber];
-    for (unsigned int i = 0; i < task->objects.size(); i++) {
-        if (task->compatibleTypes(task->objects[i].types, param.types)) {
-            Precondition updatedTerm = term;
-            replaceParameter(updatedTerm, paramNumber + numParameters, i);
-            if (paramNumber + 1 < prec.parameters.size())
-                replaceQuantifierParameter(prec, updatedTerm, paramNumber + 1, numParameters);
-            else
-                prec.terms.push_back(updatedTerm);
-        }
+    for (unsigned int objectIndex : getCompatibleObjects(param)) {
+        Precondition updatedTerm = term;
+        replaceParameter(updatedTerm, paramNumber + numParameters, objectIndex);
+        if (paramNumber + 1 < prec.parameters.size())
+            replaceQuantifierParameter(prec, updatedTerm, paramNumber + 1, numParameters);
+        else
+            prec.terms.push_back(std::move(updatedTerm));
     }
 }
 
 // Replaces the parameters of a quantifier by the task object that matches
-void Preprocess::replaceQuantifierParameter(DurativeCondition &prec, DurativeCondition term, 
+void Preprocess::replaceQuantifierParameter(DurativeCondition &prec, const DurativeCondition &term, 
         unsigned int paramNumber, unsigned int numParameters) {
     Variable &param = prec.parameters[paramNumber];
-    for (unsigned int i = 0; i < task->objects.size(); i++) {
-        if (task->compatibleTypes(task->objects[i].types, param.types)) {
-            DurativeCondition updatedTerm = term;
-            replaceParameter(updatedTerm, paramNumber + numParameters, i);
-            if (paramNumber + 1 < prec.parameters.size())
-                replaceQuantifierParameter(prec, updatedTerm, paramNumber + 1, numParameters);
-            else
-                prec.conditions.push_back(updatedTerm);
-        }
+    for (unsigned int objectIndex : getCompatibleObjects(param)) {
+        DurativeCondition updatedTerm = term;
+        replaceParameter(updatedTerm, paramNumber + numParameters, objectIndex);
+        if (paramNumber + 1 < prec.parameters.size())
+            replaceQuantifierParameter(prec, updatedTerm, paramNumber + 1, numParameters);
+        else
+            prec.conditions.push_back(std::move(updatedTerm));
     }
 }
         
 // Replaces the parameters of a quantifier by the task object that matches
-void Preprocess::replaceQuantifierParameter(Effect &eff, Effect term, 
+void Preprocess::replaceQuantifierParameter(Effect &eff, const Effect &term, 
         unsigned int paramNumber, unsigned int numParameters) {
     Variable &param = eff.parameters[paramNumber];
-    for (unsigned int i = 0; i < task->objects.size(); i++) {
-        if (task->compatibleTypes(task->objects[i].types, param.types)) {
-            Effect updatedTerm = term;
-            replaceParameter(updatedTerm, paramNumber + numParameters, i);
-            if (paramNumber + 1 < eff.parameters.size())
-                replaceQuantifierParameter(eff, updatedTerm, paramNumber + 1, numParameters);
-            else
-                eff.terms.push_back(updatedTerm);
-        }
+    for (unsigned int objectIndex : getCompatibleObjects(param)) {
+        Effect updatedTerm = term;
+        replaceParameter(updatedTerm, paramNumber + numParameters, objectIndex);
+        if (paramNumber + 1 < eff.parameters.size())
+            replaceQuantifierParameter(eff, updatedTerm, paramNumber + 1, numParameters);
+        else
+            eff.terms.push_back(std::move(updatedTerm));
     }
 }
 
 // Replaces the parameters of a quantifier by the task object that matches
-void Preprocess::replaceQuantifierParameter(DurativeEffect &eff, DurativeEffect term, 
+void Preprocess::replaceQuantifierParameter(DurativeEffect &eff, const DurativeEffect &term, 
         unsigned int paramNumber, unsigned int numParameters) {
     Variable &param = eff.parameters[paramNumber];
-    for (unsigned int i = 0; i < task->objects.size(); i++) {
-        if (task->compatibleTypes(task->objects[i].types, param.types)) {
-            DurativeEffect updatedTerm = term;
-            replaceParameter(updatedTerm, paramNumber + numParameters, i);
-            if (paramNumber + 1 < eff.parameters.size())
-                replaceQuantifierParameter(eff, updatedTerm, paramNumber + 1, numParameters);
-            else
-                eff.terms.push_back(updatedTerm);
-        }
+    for (unsigned int objectIndex : getCompatibleObjects(param)) {
+        DurativeEffect updatedTerm = term;
+        replaceParameter(updatedTerm, paramNumber + numParameters, objectIndex);
+        if (paramNumber + 1 < eff.parameters.size())
+            replaceQuantifierParameter(eff, updatedTerm, paramNumber + 1, numParameters);
+        else
+            eff.terms.push_back(std::move(updatedTerm));
     }
 }
     
 // Replaces the parameters of a quantifier by the task object that matches
-void Preprocess::replaceQuantifierParameter(GoalDescription &goal, GoalDescription term, 
+void Preprocess::replaceQuantifierParameter(GoalDescription &goal, const GoalDescription &term, 
         unsigned int paramNumber, unsigned int numParameters) {
     Variable &param = goal.parameters[paramNumber];
-    for (unsigned int i = 0; i < task->objects.size(); i++) {
-        if (task->compatibleTypes(task->objects[i].types, param.types)) {
-            GoalDescription updatedTerm = term;
-            replaceParameter(updatedTerm, paramNumber + numParameters, i);
-            if (paramNumber + 1 < goal.parameters.size())
-                replaceQuantifierParameter(goal, updatedTerm, paramNumber + 1, numParameters);
-            else
-                goal.terms.push_back(updatedTerm);
-        }
+    for (unsigned int objectIndex : getCompatibleObjects(param)) {
+        GoalDescription updatedTerm = term;
+        replaceParameter(updatedTerm, paramNumber + numParameters, objectIndex);
+        if (paramNumber + 1 < goal.parameters.size())
+            replaceQuantifierParameter(goal, updatedTerm, paramNumber + 1, numParameters);
+        else
+            goal.terms.push_back(std::move(updatedTerm));
     }       
 }
  
@@ -667,11 +852,10 @@ void Preprocess::removeImplications(Precondition &prec) {
     case PT_IMPLY:
         {
             prec.type = PT_OR;
-            Precondition &p = prec.terms[0];
             Precondition notP;
             notP.type = PT_NOT;
-            notP.terms.push_back(p);
-            prec.terms[0] = notP;
+            notP.terms.push_back(std::move(prec.terms[0]));
+            prec.terms[0] = std::move(notP);
             removeImplications(prec.terms[0]);
             removeImplications(prec.terms[1]);
         }
@@ -743,11 +927,10 @@ void Preprocess::removeImplications(GoalDescription &goal) {
     case GD_IMPLY:
         {
             goal.type = GD_OR;
-            GoalDescription &p = goal.terms[0];
             GoalDescription notP;
             notP.type = GD_NOT;
-            notP.terms.push_back(p);
-            goal.terms[0] = notP;
+            notP.terms.push_back(std::move(goal.terms[0]));
+            goal.terms[0] = std::move(notP);
             removeImplications(goal.terms[0]);
             removeImplications(goal.terms[1]);
         }
@@ -765,12 +948,12 @@ void Preprocess::preconditionOptimization(Precondition *prec, Precondition *pare
         case PT_OR:
             if (n == 0) prec->type = PT_AND;    // Empty conjuntion/disjunction
             else if (n == 1) {                  // Unary conjuntion/disjunction
-                Precondition child = prec->terms[0];
+                Precondition child = std::move(prec->terms[0]);
                 if (parent == nullptr) {
-                    a.precondition = child;
+                    a.precondition = std::move(child);
                     preconditionOptimization(&a.precondition, nullptr, 0, a);
                 } else {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     preconditionOptimization(&(parent->terms[termNumber]), parent, termNumber, a);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -791,12 +974,12 @@ void Preprocess::preconditionOptimization(DurativeCondition *prec, DurativeCondi
     switch (prec->type) {
     case CT_AND:
         if (n == 1) {                       // Unary conjuntion/disjunction
-            DurativeCondition child = prec->conditions[0];
+            DurativeCondition child = std::move(prec->conditions[0]);
             if (parent == nullptr) {
-                a.condition = child;
+                a.condition = std::move(child);
                 preconditionOptimization(&a.condition, nullptr, 0, a);
             } else {
-                parent->conditions[termNumber] = child;
+                parent->conditions[termNumber] = std::move(child);
                 preconditionOptimization(&(parent->conditions[termNumber]), parent, termNumber, a);
             }
         } else {                            // Multiple conjuntion/disjunction
@@ -819,40 +1002,45 @@ void Preprocess::negationOptimization(Precondition *prec, Precondition *parent,
     switch (child.type) {
     case PT_LITERAL:
         prec->type = PT_NEG_LITERAL;
-        prec->literal = child.literal;
+        prec->literal = std::move(child.literal);
         prec->terms.clear();
         break;
     case PT_AND:    // ~(A ^ B) = ~A v ~B
     case PT_OR:     // ~(A v B) = ~A ^ ~B
         prec->type = child.type == PT_AND ? PT_OR : PT_AND;
-        for (unsigned int i = 0; i < child.terms.size(); i++) {
-            Precondition notP;
-            notP.type = PT_NOT;
-            notP.terms.push_back(child.terms[i]);
-            prec->terms.push_back(notP);
+        {
+            vector<Precondition> childTerms = std::move(child.terms);
+            prec->terms.clear();
+            for (Precondition& term : childTerms) {
+                prec->terms.emplace_back();
+                prec->terms.back().type = PT_NOT;
+                prec->terms.back().terms.push_back(std::move(term));
+            }
         }
-        prec->terms.erase(prec->terms.begin());
         for (unsigned int i = 0; i < prec->terms.size(); i++)
             negationOptimization(&(prec->terms[i]), prec, i, a);
         break;
     case PT_NOT:    // Double negation: ~~A = A
-        if (parent == nullptr) {
-            a.precondition = child.terms[0];
-            preconditionOptimization(&a.precondition, nullptr, 0, a);
-        } else {
-            parent->terms[termNumber] = child.terms[0];
-            preconditionOptimization(&(parent->terms[termNumber]), parent, termNumber, a); 
+        {
+            Precondition grandChild = std::move(child.terms[0]);
+            if (parent == nullptr) {
+                a.precondition = std::move(grandChild);
+                preconditionOptimization(&a.precondition, nullptr, 0, a);
+            } else {
+                parent->terms[termNumber] = std::move(grandChild);
+                preconditionOptimization(&(parent->terms[termNumber]), parent, termNumber, a); 
+            }
         }
         break;
     case PT_F_CMP:
         prec->type = PT_F_CMP;
-        prec->goal = prec->terms[0].goal;
+        prec->goal = std::move(prec->terms[0].goal);
         prec->goal.comparator = negateComparator(prec->goal.comparator);
         prec->terms.clear();
         break;
     case PT_EQUALITY:
         prec->type = PT_EQUALITY;
-        prec->goal = prec->terms[0].goal;
+        prec->goal = std::move(prec->terms[0].goal);
         prec->goal.type = prec->goal.type == GD_EQUALITY ? GD_INEQUALITY : GD_EQUALITY;
         prec->terms.clear();
         break;
@@ -878,12 +1066,12 @@ void Preprocess::effectOptimization(Effect *eff, Effect *parent, unsigned int te
     switch (eff->type) {
         case ET_AND:
             if (n == 1) {                // Unary conjuntion
-                Effect child = eff->terms[0];
+                Effect child = std::move(eff->terms[0]);
                 if (parent == nullptr) {
-                    a.effect = child;
+                    a.effect = std::move(child);
                     effectOptimization(&a.effect, nullptr, 0, a);
                 } else {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     effectOptimization(&(parent->terms[termNumber]), parent, termNumber, a);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -908,12 +1096,12 @@ void Preprocess::effectOptimization(DurativeEffect *eff, DurativeEffect *parent,
     switch (eff->type) {
         case DET_AND:
             if (n == 1) {                // Unary conjuntion
-                DurativeEffect child = eff->terms[0];
+                DurativeEffect child = std::move(eff->terms[0]);
                 if (parent == nullptr) {
-                    a.effect = child;
+                    a.effect = std::move(child);
                     effectOptimization(&a.effect, nullptr, 0, a);
                 } else {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     effectOptimization(&(parent->terms[termNumber]), parent, termNumber, a);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -940,12 +1128,12 @@ void Preprocess::effectOptimization(TimedEffect* eff, TimedEffect* parent, unsig
         case TE_AND:
         case TE_OR:
             if (n == 1) {                // Unary conjuntion
-                TimedEffect child = eff->terms[0];
+                TimedEffect child = std::move(eff->terms[0]);
                 if (parent == nullptr) {
-                    parentEff->timedEffect = child;
+                    parentEff->timedEffect = std::move(child);
                     effectOptimization(&(parentEff->timedEffect), nullptr, 0, parentEff);
                 } else {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     effectOptimization(&(parent->terms[termNumber]), parent, termNumber, nullptr);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -968,12 +1156,12 @@ void Preprocess::preconditionOptimization(DurativeCondition *prec, DurativeCondi
     switch (prec->type) {
     case CT_AND:
         if (n == 1) {                       // Unary conjuntion/disjunction
-            DurativeCondition child = prec->conditions[0];
+            DurativeCondition child = std::move(prec->conditions[0]);
             if (parent == nullptr) {
-                parentEff->condition = child;
+                parentEff->condition = std::move(child);
                 preconditionOptimization(&(parentEff->condition), nullptr, 0, parentEff);
             } else {
-                parent->conditions[termNumber] = child;
+                parent->conditions[termNumber] = std::move(child);
                 preconditionOptimization(&(parent->conditions[termNumber]), parent, termNumber, parentEff);
             }
         } else {                            // Multiple conjuntion/disjunction
@@ -996,28 +1184,33 @@ void Preprocess::negationOptimization(TimedEffect* eff, TimedEffect* parent, uns
         case TE_AND:    // ~(A ^ B) = ~A v ~B
         case TE_OR:     // ~(A v B) = ~A ^ ~B
             eff->type = child.type == TE_AND ? TE_OR : TE_AND;
-            for (unsigned int i = 0; i < child.terms.size(); i++) {
-                TimedEffect notP;
-                notP.type = TE_NOT;
-                notP.terms.push_back(child.terms[i]);
-                eff->terms.push_back(notP);
+            {
+                vector<TimedEffect> childTerms = std::move(child.terms);
+                eff->terms.clear();
+                for (TimedEffect& term : childTerms) {
+                    eff->terms.emplace_back();
+                    eff->terms.back().type = TE_NOT;
+                    eff->terms.back().terms.push_back(std::move(term));
+                }
             }
-            eff->terms.erase(eff->terms.begin());
             for (unsigned int i = 0; i < eff->terms.size(); i++)
                 negationOptimization(&(eff->terms[i]), eff, i, parentEff);
             break;
         case TE_NOT:    // Double negation: ~~A = A
-            if (parent != nullptr) {
-                parent->terms[termNumber] = child.terms[0];
-                effectOptimization(&(parent->terms[termNumber]), parent, termNumber, parentEff);
-            } else {
-                parentEff->timedEffect = child.terms[0];
-                effectOptimization(&(parentEff->timedEffect), nullptr, 0, parentEff);
+            {
+                TimedEffect grandChild = std::move(child.terms[0]);
+                if (parent != nullptr) {
+                    parent->terms[termNumber] = std::move(grandChild);
+                    effectOptimization(&(parent->terms[termNumber]), parent, termNumber, parentEff);
+                } else {
+                    parentEff->timedEffect = std::move(grandChild);
+                    effectOptimization(&(parentEff->timedEffect), nullptr, 0, parentEff);
+                }
             }
             break;
         case TE_LITERAL:
             eff->type = TE_NEG_LITERAL;
-            eff->literal = child.literal;
+            eff->literal = std::move(child.literal);
             eff->terms.clear();
             break;
         case TE_ASSIGNMENT:;
@@ -1032,16 +1225,19 @@ void Preprocess::negationOptimization(Effect *eff, Effect *parent, unsigned int
     switch (child.type) {
     case ET_LITERAL:
         eff->type = ET_NEG_LITERAL;
-        eff->literal = child.literal;
+        eff->literal = std::move(child.literal);
         eff->terms.clear();
         break;
     case ET_NOT:    // Double negation: ~~A = A
-        if (parent == nullptr) {
-            a.effect = child.terms[0];
-            effectOptimization(&a.effect, nullptr, 0, a);
-        } else {
-            parent->terms[termNumber] = child.terms[0];
-            effectOptimization(&(parent->terms[termNumber]), parent, termNumber, a); 
+        {
+            Effect grandChild = std::move(child.terms[0]);
+            if (parent == nullptr) {
+                a.effect = std::move(grandChild);
+                effectOptimization(&a.effect, nullptr, 0, a);
+            } else {
+                parent->terms[termNumber] = std::move(grandChild);
+                effectOptimization(&(parent->terms[termNumber]), parent, termNumber, a); 
+            }
         }
         break;
     case ET_WHEN:
@@ -1060,15 +1256,15 @@ void Preprocess::goalOptimization(GoalDescription *goal, Precondition *parentPre
         case GD_OR:
             if (n == 0) goal->type = GD_AND;    // Empty conjuntion/disjunction
             else if (n == 1) {                  // Unary conjuntion/disjunction
-                GoalDescription child = goal->terms[0];
+                GoalDescription child = std::move(goal->terms[0]);
                 if (parent != nullptr) {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     goalOptimization(&(parent->terms[termNumber]), nullptr, nullptr, parent, termNumber);
                 } else if (parentPrec != nullptr) {
-                    parentPrec->goal = child;
+                    parentPrec->goal = std::move(child);
                     goalOptimization(&(parentPrec->goal), parentPrec, nullptr, nullptr, 0);
                 } else {
-                    parentEff->goal = child;
+                    parentEff->goal = std::move(child);
                     goalOptimization(&(parentEff->goal), nullptr, parentEff, nullptr, 0);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -1092,12 +1288,12 @@ void Preprocess::goalOptimization(GoalDescription *goal, DurativeCondition *pare
         case GD_OR:
             if (n == 0) goal->type = GD_AND;    // Empty conjuntion/disjunction
             else if (n == 1) {                  // Unary conjuntion/disjunction
-                GoalDescription child = goal->terms[0];
+                GoalDescription child = std::move(goal->terms[0]);
                 if (parent != nullptr) {
-                    parent->terms[termNumber] = child;
+                    parent->terms[termNumber] = std::move(child);
                     goalOptimization(&(parent->terms[termNumber]), nullptr, parent, termNumber);
                 } else {
-                    parentPrec->goal = child;
+                    parentPrec->goal = std::move(child);
                     goalOptimization(&(parentPrec->goal), parentPrec, nullptr, 0);
                 }
             } else {                            // Multiple conjuntion/disjunction
@@ -1120,7 +1316,7 @@ void Preprocess::negationOptimization(GoalDescription *goal, DurativeCondition *
     case GD_LITERAL:
          //cout << "Child literal" << endl;
         goal->type = GD_NEG_LITERAL;
-        goal->literal = child.literal;
+        goal->literal = std::move(child.literal);
         goal->time = child.time;
         goal->terms.clear();
         break;
@@ -1128,31 +1324,36 @@ void Preprocess::negationOptimization(GoalDescription *goal, DurativeCondition *
     case GD_OR:     // ~(A v B) = ~A ^ ~B
         //cout << "Child and/or" << endl;
         goal->type = child.type == GD_AND ? GD_OR : GD_AND;
-        for (unsigned int i = 0; i < child.terms.size(); i++) {
-            GoalDescription notP;
-            notP.type = GD_NOT;
-            notP.terms.push_back(child.terms[i]);
-            goal->terms.push_back(notP);
+        {
+            vector<GoalDescription> childTerms = std::move(child.terms);
+            goal->terms.clear();
+            for (GoalDescription& term : childTerms) {
+                goal->terms.emplace_back();
+                goal->terms.back().type = GD_NOT;
+                goal->terms.back().terms.push_back(std::move(term));
+            }
         }
-        goal->terms.erase(goal->terms.begin());
         for (unsigned int i = 0; i < goal->terms.size(); i++)
             negationOptimization(&(goal->terms[i]), nullptr, nullptr, goal, i);
         break;
     case GD_NOT:    // Double negation: ~~A = A
-        //cout << "Child not" << endl;
-        if (parent != nullptr) {
-            parent->terms[termNumber] = child.terms[0];
-            goalOptimization(&(parent->terms[termNumber]), nullptr, nullptr, parent, termNumber);
-        } else {
-            parentPrec->goal = child.terms[0];
-            goalOptimization(&(parentPrec->goal), parentPrec, nullptr, 0);
+        {
+            GoalDescription grandChild = std::move(child.terms[0]);
+            //cout << "Child not" << endl;
+            if (parent != nullptr) {
+                parent->terms[termNumber] = std::move(grandChild);
+                goalOptimization(&(parent->terms[termNumber]), nullptr, nullptr, parent, termNumber);
+            } else {
+                parentPrec->goal = std::move(grandChild);
+                goalOptimization(&(parentPrec->goal), parentPrec, nullptr, 0);
+            }
         }
         break;
     case GD_F_CMP:
          //cout << "Child cmp" << endl;
         goal->type = GD_F_CMP;
         goal->time = child.time;
-        goal->exp = goal->terms[0].exp;
+        goal->exp = std::move(goal->terms[0].exp);
         goal->comparator = negateComparator(child.comparator);
         goal->terms.clear();
         break;
@@ -1160,7 +1361,7 @@ void Preprocess::negationOptimization(GoalDescription *goal, DurativeCondition *
          //cout << "Child equality" << endl;
         goal->type = GD_INEQUALITY;
         goal->time = child.time;
-        goal->eqTerms = goal->terms[0].eqTerms;
+        goal->eqTerms = std::move(goal->terms[0].eqTerms);
         goal->terms.clear();
         break;
     default:;
@@ -1174,46 +1375,51 @@ void Preprocess::negationOptimization(GoalDescription *goal, Precondition *paren
     switch (child.type) {
     case GD_LITERAL:
         goal->type = GD_NEG_LITERAL;
-        goal->literal = child.literal;
+        goal->literal = std::move(child.literal);
         goal->time = child.time;
         goal->terms.clear();
         break;
     case GD_AND:    // ~(A ^ B) = ~A v ~B
     case GD_OR:     // ~(A v B) = ~A ^ ~B
         goal->type = child.type == GD_AND ? GD_OR : GD_AND;
-        for (unsigned int i = 0; i < child.terms.size(); i++) {
-            GoalDescription notP;
-            notP.type = GD_NOT;
-            notP.terms.push_back(child.terms[i]);
-            goal->terms.push_back(notP);
+        {
+            vector<GoalDescription> childTerms = std::move(child.terms);
+            goal->terms.clear();
+            for (GoalDescription& term : childTerms) {
+                goal->terms.emplace_back();
+                goal->terms.back().type = GD_NOT;
+                goal->terms.back().terms.push_back(std::move(term));
+            }
         }
-        goal->terms.erase(goal->terms.begin());
         for (unsigned int i = 0; i < goal->terms.size(); i++)
             negationOptimization(&(goal->terms[i]), nullptr, nullptr, goal, i);
         break;
     case GD_NOT:    // Double negation: ~~A = A
-        if (parent != nullptr) {
-            parent->terms[termNumber] = child.terms[0];
-            goalOptimization(&(parent->terms[termNumber]), nullptr, nullptr, parent, termNumber);
-        } else if (parentPrec != nullptr) {
-            parentPrec->goal = child.terms[0];
-            goalOptimization(&(parentPrec->goal), parentPrec, nullptr, nullptr, 0);
-        } else {
-            parentEff->goal = child.terms[0];
-            goalOptimization(&(parentEff->goal), nullptr, parentEff, nullptr, 0);
+        {
+            GoalDescription grandChild = std::move(child.terms[0]);
+            if (parent != nullptr) {
+                parent->terms[termNumber] = std::move(grandChild);
+                goalOptimization(&(parent->terms[termNumber]), nullptr, nullptr, parent, termNumber);
+            } else if (parentPrec != nullptr) {
+                parentPrec->goal = std::move(grandChild);
+                goalOptimization(&(parentPrec->goal), parentPrec, nullptr, nullptr, 0);
+            } else {
+                parentEff->goal = std::move(grandChild);
+                goalOptimization(&(parentEff->goal), nullptr, parentEff, nullptr, 0);
+            }
         }
         break;
     case GD_F_CMP:
         goal->type = GD_F_CMP;
         goal->time = child.time;
-        goal->exp = goal->terms[0].exp;
+        goal->exp = std::move(goal->terms[0].exp);
         goal->comparator = negateComparator(child.comparator);
         goal->terms.clear();
         break;
     case GD_EQUALITY:
         goal->type = GD_INEQUALITY;
         goal->time = child.time;
-        goal->eqTerms = goal->terms[0].eqTerms;
+        goal->eqTerms = std::move(goal->terms[0].eqTerms);
         goal->terms.clear();
         break;
     default:;
@@ -1221,18 +1427,20 @@ void Preprocess::negationOptimization(GoalDescription *goal, Precondition *paren
 }
 
 // Removes the conditional effects from the given action. Resulting actions are stored in aList
-void Preprocess::removeConditionalEffects(Action a, vector<Action> &aList) {
+void Preprocess::removeConditionalEffects(Action &a, vector<Action> &aList) {
     if (existingConditionalEffects(a.effect)) {
+        Action other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     }
 }
 
 // Removes the conditional effects from the given action. Resulting actions are stored in aList
-void Preprocess::removeConditionalEffects(DurativeAction a, std::vector<DurativeAction> &aList) {
+void Preprocess::removeConditionalEffects(DurativeAction &a, std::vector<DurativeAction> &aList) {
     if (existingConditionalEffects(a.effect)) {
+        DurativeAction other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     }
 }
 
@@ -1274,46 +1482,50 @@ bool Preprocess::existingConditionalEffects(DurativeEffect &eff) {
 }
     
 // Recursively removes the conditional effects from the action
-void Preprocess::ignoreConditionalEffect(Action a, std::vector<Action> &aList) {
+void Preprocess::ignoreConditionalEffect(Action &a, std::vector<Action> &aList) {
     removeConditionalEffect(&(a.effect), nullptr, 0, a);
     if (existingConditionalEffects(a.effect)) {
+        Action other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     } else {
-        aList.push_back(a);
+        aList.push_back(std::move(a));
     }
 }
 
 // Recursively removes the conditional effects from the action
-void Preprocess::ignoreConditionalEffect(DurativeAction a, std::vector<DurativeAction> &aList) {
+void Preprocess::ignoreConditionalEffect(DurativeAction &a, std::vector<DurativeAction> &aList) {
     removeConditionalEffect(&(a.effect), nullptr, 0, a);
     if (existingConditionalEffects(a.effect)) {
+        DurativeAction other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     } else {
-        aList.push_back(a);
+        aList.push_back(std::move(a));
     }
 }
     
 // Recursively removes the conditional effects from the action
-void Preprocess::considerConditionalEffect(Action a, std::vector<Action> &aList) {
+void Preprocess::considerConditionalEffect(Action &a, std::vector<Action> &aList) {
     manageConditionalEffect(&(a.effect), nullptr, 0, a);
     if (existingConditionalEffects(a.effect)) {
+        Action other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     } else {
-        aList.push_back(a);
+        aList.push_back(std::move(a));
     }
 }
 
 // Recursively removes the conditional effects from the action
-void Preprocess::considerConditionalEffect(DurativeAction a, std::vector<DurativeAction> &aList) {
+void Preprocess::considerConditionalEffect(DurativeAction &a, std::vector<DurativeAction> &aList) {
     manageConditionalEffect(&(a.effect), 0, a);
     if (existingConditionalEffects(a.effect)) {
+        DurativeAction other = a;
         ignoreConditionalEffect(a, aList);
-        considerConditionalEffect(a, aList);
+        considerConditionalEffect(other, aList);
     } else {
-        aList.push_back(a);
+        aList.push_back(std::move(a));
     }
 }
     
@@ -1390,19 +1602,18 @@ bool Preprocess::manageConditionalEffect(Effect *eff, Effect *parent, int numTer
     case ET_WHEN:
         {
             if (a.precondition.type != PT_AND) {
-                Precondition backup = a.precondition;
                 Precondition root;
                 root.type = PT_AND;
-                root.terms.push_back(backup);
-                a.precondition = root;
+                root.terms.push_back(std::move(a.precondition));
+                a.precondition = std::move(root);
             }
-            Precondition newPrec;
+            a.precondition.terms.emplace_back();
+            Precondition &newPrec = a.precondition.terms.back();
             newPrec.type = PT_GOAL;
-            newPrec.goal = eff->goal;
-            a.precondition.terms.push_back(newPrec);
-            Effect q = eff->terms[0];
-            if (parent != nullptr) parent->terms[numTerm] = q;
-            else a.effect = q;
+            newPrec.goal = std::move(eff->goal);
+            Effect q = std::move(eff->terms[0]);
+            if (parent != nullptr) parent->terms[numTerm] = std::move(q);
+            else a.effect = std::move(q);
             managed = true;
         }
         break;
@@ -1422,13 +1633,12 @@ bool Preprocess::manageConditionalEffect(DurativeEffect *eff, int numTerm, Durat
     case DET_WHEN:
         {
             if (a.condition.type != CT_AND) {
-                DurativeCondition backup = a.condition;
                 DurativeCondition root;
                 root.type = CT_AND;
-                root.conditions.push_back(backup);
-                a.condition = root;
+                root.conditions.push_back(std::move(a.condition));
+                a.condition = std::move(root);
             }
-            a.condition.conditions.push_back(eff->condition);
+            a.condition.conditions.push_back(std::move(eff->condition));
             eff->type = DET_TIMED_EFFECT;
             managed = true;
         }
@@ -1441,32 +1651,87 @@ bool Preprocess::manageConditionalEffect(DurativeEffect *eff, int numTerm, Durat
 // Builds one operator (or more if there are disjunctions in the precondition) from the given action
 // and stores them in prepTask->operators
 void Preprocess::buildOperators(Action &a, bool isGoal) {
-    Operator op;
-    vector<Operator> opList = buildOperatorPrecondition(a.precondition, a, &op);
+    vector<Operator> opList(1);
+    startBuildingOperators(a.parameters, noControlVars);
+    buildOperatorPrecondition(a.precondition, a, opList);
+    reduceOperators(opList, true);
+    if (maxOperatorsPerAction > 0) remainingOperators -= opList.size();
     for (unsigned int i = 0; i < opList.size(); i++) {
-        if (checkValidOperator(opList[i], a.parameters.size())) {
-            opList[i].isGoal = isGoal;
-            terminateBuildingOperator(opList[i], a);
-        }
+        opList[i].isGoal = isGoal;
+        terminateBuildingOperator(opList[i], a);
     }
 }
 
 // Builds one operator (or more if there are disjunctions in the precondition) from the given action
 // and stores them in prepTask->operators
 void Preprocess::buildOperators(DurativeAction &a, bool isGoal) {
-    Operator op;
-    vector<Operator> opList = buildOperatorPrecondition(a.condition, a, &op);
+    vector<Operator> opList(1);
+    startBuildingOperators(a.parameters, a.controlVars);
+    buildOperatorPrecondition(a.condition, a, opList);
+    reduceOperators(opList, true);
+    if (maxOperatorsPerAction > 0) remainingOperators -= opList.size();
     for (unsigned int i = 0; i < opList.size(); i++) {
-        if (checkValidOperator(opList[i], a.parameters.size())) {
-            opList[i].isGoal = isGoal;
-            terminateBuildingOperator(opList[i], a);
+        opList[i].isGoal = isGoal;
+        terminateBuildingOperator(opList[i], a);
+    }
+}
+
+// Sets the action whose operators are being built
+void Preprocess::startBuildingOperators(const vector<Variable> &parameters, const vector<Variable> &controlVars) {
+    opParameters = &parameters;
+    opControlVars = &controlVars;
+}
+
+// Splits every operator of the list in one operator per alternative of the disjunction. The
+// alternatives are taken in reverse order, as the operators have always been generated
+void Preprocess::buildOperatorDisjunction(std::vector<Precondition> &terms, Action &a, vector<Operator> &opList) {
+    vector<Operator> result;
+    for (unsigned int i = 0; i < opList.size(); i++) {
+        if (!consistentOperator(opList[i])) continue;
+        for (unsigned int j = terms.size(); j-- > 0; ) {
+            vector<Operator> partial(1, opList[i]);
+            buildOperatorPrecondition(terms[j], a, partial);
+            result.insert(result.end(), make_move_iterator(partial.begin()), make_move_iterator(partial.end()));
         }
     }
+    opList = std::move(result);
+    reduceOperators(opList, false);
 }
-    
-// Builds the operator precondition from the action precondition
-vector<Operator> Preprocess::buildOperatorPrecondition(Precondition &prec, Action &a, Operator *op) {
-    vector<Operator> opList;
+
+// Splits every operator of the list in one operator per alternative of the disjunction. The
+// alternatives are taken in reverse order, as the operators have always been generated
+void Preprocess::buildOperatorDisjunction(std::vector<GoalDescription> &terms, Action &a, vector<Operator> &opList) {
+    vector<Operator> result;
+    for (unsigned int i = 0; i < opList.size(); i++) {
+        if (!consistentOperator(opList[i])) continue;
+        for (unsigned int j = terms.size(); j-- > 0; ) {
+            vector<Operator> partial(1, opList[i]);
+            buildOperatorPrecondition(terms[j], a, partial);
+            result.insert(result.end(), make_move_iterator(partial.begin()), make_move_iterator(partial.end()));
+        }
+    }
+    opList = std::move(result);
+    reduceOperators(opList, false);
+}
+
+// Splits every operator of the list in one operator per alternative of the disjunction. The
+// alternatives are taken in reverse order, as the operators have always been generated
+void Preprocess::buildOperatorDisjunction(std::vector<GoalDescription> &terms, DurativeAction &a, vector<Operator> &opList) {
+    vector<Operator> result;
+    for (unsigned int i = 0; i < opList.size(); i++) {
+        if (!consistentOperator(opList[i])) continue;
+        for (unsigned int j = terms.size(); j-- > 0; ) {
+            vector<Operator> partial(1, opList[i]);
+            buildOperatorPrecondition(terms[j], a, partial);
+            result.insert(result.end(), make_move_iterator(partial.begin()), make_move_iterator(partial.end()));
+        }
+    }
+    opList = std::move(result);
+    reduceOperators(opList, false);
+}
+
+// Adds the action precondition to every operator of the list
+void Preprocess::buildOperatorPrecondition(Precondition &prec, Action &a, vector<Operator> &opList) {
     switch (prec.type) {
     case PT_LITERAL:
     case PT_NEG_LITERAL:
@@ -1474,79 +1739,68 @@ vector<Operator> Preprocess::buildOperatorPrecondition(Precondition &prec, Actio
             Term value;
             value.type = TERM_CONSTANT;
             value.index = prec.type == PT_LITERAL ? task->CONSTANT_TRUE : task->CONSTANT_FALSE;
-            op->addLiteralToPreconditions(prec.literal, value, AT_START);
-            opList.push_back(*op);
+            for (Operator &op : opList)
+                op.addLiteralToPreconditions(prec.literal, value, AT_START);
         }
         break;
     case PT_AND:
-        if (prec.terms.size() < 1) opList.push_back(*op);
-        else opList = buildOperatorPreconditionAnd(prec, a, op, 0);
+        for (unsigned int i = 0; i < prec.terms.size() && !opList.empty(); i++)
+            buildOperatorPrecondition(prec.terms[i], a, opList);
         break;
     case PT_OR:
-        for (unsigned int i = 0; i < prec.terms.size(); i++) {
-            Operator newOp = *op;
-            vector<Operator> partial = buildOperatorPrecondition(prec.terms[i], a, &newOp);
-            opList.insert(opList.begin(), partial.begin(), partial.end());
-        }
+        buildOperatorDisjunction(prec.terms, a, opList);
         break;
     case PT_F_CMP:
-        op->addNumericPrecondition(prec.goal, AT_START);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addNumericPrecondition(prec.goal, AT_START);
         break;
     case PT_EQUALITY:
-        op->addEquality(prec.goal.eqTerms[0], prec.goal.eqTerms[1], prec.goal.type == GD_EQUALITY);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addEquality(prec.goal.eqTerms[0], prec.goal.eqTerms[1], prec.goal.type == GD_EQUALITY);
         break;
     case PT_PREFERENCE:
         {
             OpPreference pref;
             pref.name = prec.preferenceName;
             pref.preference = prec.goal;
-            op->preference.push_back(pref);
-            opList.push_back(*op);
+            for (Operator &op : opList)
+                op.preference.push_back(pref);
         }
         break;
     case PT_GOAL:
-        opList = buildOperatorPrecondition(prec.goal, a, op);
+        buildOperatorPrecondition(prec.goal, a, opList);
         break;
-    default:;
+    default:
+        opList.clear();
     }
-    return opList;
 }
 
-// Builds the operator precondition from the action precondition
-vector<Operator> Preprocess::buildOperatorPrecondition(DurativeCondition &prec, DurativeAction &a, Operator *op) {
-    vector<Operator> opList;
-    //cout << "Aqui (" << prec.type << ") ";
+// Adds the action precondition to every operator of the list
+void Preprocess::buildOperatorPrecondition(DurativeCondition &prec, DurativeAction &a, vector<Operator> &opList) {
     switch (prec.type) {
     case CT_AND:
-        //cout << "and" << endl;
-        if (prec.conditions.size() < 1) opList.push_back(*op);
-        else opList = buildOperatorPreconditionAnd(prec, a, op, 0);
+        for (unsigned int i = 0; i < prec.conditions.size() && !opList.empty(); i++)
+            buildOperatorPrecondition(prec.conditions[i], a, opList);
         break;
     case CT_GOAL:
-        //cout << "goal" << endl; 
-        opList = buildOperatorPrecondition(prec.goal, a, op);
+        buildOperatorPrecondition(prec.goal, a, opList);
         break;
     case CT_PREFERENCE:
-        //cout << "pref" << endl; 
         {
             OpPreference pref;
             pref.name = prec.preferenceName;
             pref.preference = prec.goal;
-            op->preference.push_back(pref);
-            opList.push_back(*op);
+            for (Operator &op : opList)
+                op.preference.push_back(pref);
         }
         break;
-    default:;
+    default:
+        opList.clear();
     }
-    //cout << " with size " << opList.size() << endl;
-    return opList;
 }
     
-// Builds the operator precondition from the action precondition
-vector<Operator> Preprocess::buildOperatorPrecondition(GoalDescription &goal, Action &a, Operator *op) {
-    vector<Operator> opList;
+// Adds the action precondition to every operator of the list
+void Preprocess::buildOperatorPrecondition(GoalDescription &goal, Action &a, vector<Operator> &opList) {
     switch (goal.type) {
     case GD_LITERAL:
     case GD_NEG_LITERAL:
@@ -1554,38 +1808,33 @@ vector<Operator> Preprocess::buildOperatorPrecondition(GoalDescription &goal, Ac
             Term value;
             value.type = TERM_CONSTANT;
             value.index = goal.type == GD_LITERAL ? task->CONSTANT_TRUE : task->CONSTANT_FALSE;
-            op->addLiteralToPreconditions(goal.literal, value, AT_START);
-            opList.push_back(*op);
+            for (Operator &op : opList)
+                op.addLiteralToPreconditions(goal.literal, value, AT_START);
         }
         break;
     case GD_AND:
-        if (goal.terms.size() < 1) opList.push_back(*op);
-        else opList = buildOperatorPreconditionAnd(goal, a, op, 0);
+        for (unsigned int i = 0; i < goal.terms.size() && !opList.empty(); i++)
+            buildOperatorPrecondition(goal.terms[i], a, opList);
         break;
     case GD_EQUALITY:
     case GD_INEQUALITY:
-        op->addEquality(goal.eqTerms[0], goal.eqTerms[1], goal.type == GD_EQUALITY);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addEquality(goal.eqTerms[0], goal.eqTerms[1], goal.type == GD_EQUALITY);
         break;
     case GD_OR:
-        for (unsigned int i = 0; i < goal.terms.size(); i++) {
-            Operator newOp = *op;
-            vector<Operator> partial = buildOperatorPrecondition(goal.terms[i], a, &newOp);
-            opList.insert(opList.begin(), partial.begin(), partial.end());
-        }
+        buildOperatorDisjunction(goal.terms, a, opList);
         break;
     case GD_F_CMP:
-        op->addNumericPrecondition(goal, AT_START);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addNumericPrecondition(goal, AT_START);
         break;
-    default:;
+    default:
+        opList.clear();
     }
-    return opList;
 }
 
-// Builds the operator precondition from the action precondition
-vector<Operator> Preprocess::buildOperatorPrecondition(GoalDescription &goal, DurativeAction &a, Operator *op) {
-    vector<Operator> opList;
+// Adds the action precondition to every operator of the list
+void Preprocess::buildOperatorPrecondition(GoalDescription &goal, DurativeAction &a, vector<Operator> &opList) {
     switch (goal.type) {
     case GD_LITERAL:
     case GD_NEG_LITERAL:
@@ -1593,81 +1842,140 @@ vector<Operator> Preprocess::buildOperatorPrecondition(GoalDescription &goal, Du
             Term value;
             value.type = TERM_CONSTANT;
             value.index = goal.type == GD_LITERAL ? task->CONSTANT_TRUE : task->CONSTANT_FALSE;
-            op->addLiteralToPreconditions(goal.literal, value, goal.time);
-            opList.push_back(*op);
+            for (Operator &op : opList)
+                op.addLiteralToPreconditions(goal.literal, value, goal.time);
         }
         break;
     case GD_AND:
-        if (goal.terms.size() < 1) opList.push_back(*op);
-        else opList = buildOperatorPreconditionAnd(goal, a, op, 0);
+        for (unsigned int i = 0; i < goal.terms.size() && !opList.empty(); i++)
+            buildOperatorPrecondition(goal.terms[i], a, opList);
         break;
     case GD_EQUALITY:
     case GD_INEQUALITY:
-        op->addEquality(goal.eqTerms[0], goal.eqTerms[1], goal.type == GD_EQUALITY);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addEquality(goal.eqTerms[0], goal.eqTerms[1], goal.type == GD_EQUALITY);
         break;
     case GD_OR:
-        for (unsigned int i = 0; i < goal.terms.size(); i++) {
-            Operator newOp = *op;
-            vector<Operator> partial = buildOperatorPrecondition(goal.terms[i], a, &newOp);
-            opList.insert(opList.begin(), partial.begin(), partial.end());
-        }
+        buildOperatorDisjunction(goal.terms, a, opList);
         break;
     case GD_F_CMP:
-        op->addNumericPrecondition(goal, goal.time);
-        opList.push_back(*op);
+        for (Operator &op : opList)
+            op.addNumericPrecondition(goal, goal.time);
         break;
-    default:;
-    }
-    return opList;
-}
-    
-// Builds the operator precondition from a conjunction in the action precondition
-vector<Operator> Preprocess::buildOperatorPreconditionAnd(Precondition &prec, Action &a, Operator *op, unsigned int numTerm) {
-    vector<Operator> opList = buildOperatorPrecondition(prec.terms[numTerm], a, op);
-    if (++numTerm >= prec.terms.size()) return opList;
-    vector<Operator> result;
-    for (unsigned int i = 0; i < opList.size(); i++) {
-        vector<Operator> partial = buildOperatorPreconditionAnd(prec, a, &opList[i], numTerm);
-        result.insert(result.end(), partial.begin(), partial.end());
+    default:
+        opList.clear();
     }
-    return result;
 }
 
-// Builds the operator precondition from a conjunction in the action precondition
-vector<Operator> Preprocess::buildOperatorPreconditionAnd(DurativeCondition &prec, DurativeAction &a, Operator *op, unsigned int numTerm) {
-    vector<Operator> opList = buildOperatorPrecondition(prec.conditions[numTerm], a, op);
-    if (++numTerm >= prec.conditions.size()) return opList;
-    vector<Operator> result;
-    for (unsigned int i = 0; i < opList.size(); i++) {
-        vector<Operator> partial = buildOperatorPreconditionAnd(prec, a, &opList[i], numTerm);
-        result.insert(result.end(), partial.begin(), partial.end());
+// Checks if a partially built operator is still consistent. Only the contradictions that no
+// later precondition can remove are detected: conflicting constant equalities and fluents
+// that require two different fixed values
+bool Preprocess::consistentOperator(Operator &op) {
+    unsigned int numParameters = opParameters->size();
+    vector<unsigned int> paramValues(numParameters, MAX_UNSIGNED_INT);
+    vector<unsigned int> equivalences(numParameters);
+    for (unsigned int i = 0; i < numParameters; i++)
+        equivalences[i] = i;
+    if (!setParameterValues(paramValues.data(), equivalences.data(), op.equality)) return false;
+    for (unsigned int i = 0; i < op.equality.size(); i++) {
+        OpEquality &eq = op.equality[i];
+        if (!eq.equal && eq.value1.type != TERM_PARAMETER && eq.value2.type != TERM_PARAMETER &&
+            eq.value1.index == eq.value2.index) return false;       // (!= X X)
     }
-    return result;
+    return consistentPreconditions(paramValues.data(), op.atStart.prec) &&
+        consistentPreconditions(paramValues.data(), op.overAllPrec) &&
+        consistentPreconditions(paramValues.data(), op.atEnd.prec);
 }
-    
-// Builds the operator precondition from a conjunction in the action precondition
-vector<Operator> Preprocess::buildOperatorPreconditionAnd(GoalDescription &goal, Action &a, Operator *op, unsigned int numTerm) {
-    vector<Operator> opList = buildOperatorPrecondition(goal.terms[numTerm], a, op);
-    if (++numTerm >= goal.terms.size()) return opList;
-    vector<Operator> result;
-    for (unsigned int i = 0; i < opList.size(); i++) {
-        vector<Operator> partial = buildOperatorPreconditionAnd(goal, a, &opList[i], numTerm);
-        result.insert(result.end(), partial.begin(), partial.end());
+
+// Checks that no fluent requires two different fixed values. Parameters without a value
+// can still be bound later, so they never cause a conflict
+bool Preprocess::consistentPreconditions(unsigned int paramValues[], vector<OpFluent> &precs) {
+    if (precs.size() > 1) {
+        unordered_map<string,string> map(32);
+        for (unsigned int i = 0; i < precs.size(); i++) {
+            Term &value = precs[i].value;
+            if (value.type == TERM_PARAMETER && paramValues[value.index] == MAX_UNSIGNED_INT) continue;
+            string varName = precs[i].getVarName(paramValues);
+            string valueName = precs[i].getValueName(paramValues);
+            unordered_map<string,string>::const_iterator got = map.find(varName);
+            if (got == map.end()) map[varName] = valueName;
+            else if (valueName.compare(got->second) != 0) return false;
+        }
     }
-    return result;
+    return true;
 }
 
-// Builds the operator precondition from a conjunction in the action precondition
-vector<Operator> Preprocess::buildOperatorPreconditionAnd(GoalDescription &goal, DurativeAction &a, Operator *op, unsigned int numTerm) {
-    vector<Operator> opList = buildOperatorPrecondition(goal.terms[numTerm], a, op);
-    if (++numTerm >= goal.terms.size()) return opList;
-    vector<Operator> result;
+// Appends a term to an operator key in binary form
+inline void appendKeyTerm(string &s, const Term &t) {
+    s.push_back((char)t.type);
+    s.append((const char*)&t.index, sizeof(t.index));
+}
+
+// Returns the preconditions of a partially built operator as a sorted list of strings without
+// repetitions, so two operators with the same preconditions (in any order) have the same key
+void Preprocess::getOperatorKey(Operator &op, vector<string> &key) {
+    vector<OpFluent>* precs[] = { &op.atStart.prec, &op.overAllPrec, &op.atEnd.prec };
+    for (unsigned int t = 0; t < 3; t++) {
+        for (unsigned int i = 0; i < precs[t]->size(); i++) {
+            OpFluent &f = (*precs[t])[i];
+            key.emplace_back(1, (char)t);
+            string &item = key.back();
+            item.append((const char*)&f.variable.fncIndex, sizeof(f.variable.fncIndex));
+            for (unsigned int j = 0; j < f.variable.params.size(); j++)
+                appendKeyTerm(item, f.variable.params[j]);
+            item.push_back('=');
+            appendKeyTerm(item, f.value);
+        }
+    }
+    vector<OpNumericPrec>* numPrecs[] = { &op.atStart.numericPrec, &op.overAllNumericPrec, &op.atEnd.numericPrec };
+    for (unsigned int t = 0; t < 3; t++) {
+        for (unsigned int i = 0; i < numPrecs[t]->size(); i++) {
+            OpNumericPrec &p = (*numPrecs[t])[i];
+            key.push_back(to_string(t) + "#" + p.toString(task->functions, task->objects, *opControlVars));
+        }
+    }
+    for (unsigned int i = 0; i < op.equality.size(); i++) {
+        OpEquality &eq = op.equality[i];
+        key.push_back(eq.equal ? "=" : "!");
+        appendKeyTerm(key.back(), eq.value1);
+        appendKeyTerm(key.back(), eq.value2);
+    }
+    for (unsigned int i = 0; i < op.preference.size(); i++)
+        key.push_back("pref" + op.preference[i].toString(*opParameters, *opControlVars, task));
+    sort(key.begin(), key.end());
+    key.erase(unique(key.begin(), key.end()), key.end());
+}
+
+// Removes the inconsistent operators of the list and those with the same preconditions as a
+// previous one, keeping the order of the rest. Complete operators are checked with
+// checkValidOperator. If there is a limit of operators per action, the list is truncated to the
+// operators that the action can still generate
+void Preprocess::reduceOperators(vector<Operator> &opList, bool complete) {
+    if (opList.empty()) return;
+    unordered_set<string> found;
+    unsigned int numOperators = 0;
     for (unsigned int i = 0; i < opList.size(); i++) {
-        vector<Operator> partial = buildOperatorPreconditionAnd(goal, a, &opList[i], numTerm);
-        result.insert(result.end(), partial.begin(), partial.end());
+        bool valid = complete ? checkValidOperator(opList[i], opParameters->size()) : consistentOperator(opList[i]);
+        if (!valid) continue;
+        if (opList.size() > 1) {
+            vector<string> key;
+            getOperatorKey(opList[i], key);
+            string joinedKey;
+            for (unsigned int j = 0; j < key.size(); j++) {
+                unsigned int length = key[j].length();
+                joinedKey.append((const char*)&length, sizeof(length));
+                joinedKey += key[j];
+            }
+            if (!found.insert(joinedKey).second) continue;      // Duplicated operator
+        }
+        if (numOperators != i) opList[numOperators] = std::move(opList[i]);
+        numOperators++;
+    }
+    opList.resize(numOperators);
+    if (maxOperatorsPerAction > 0 && opList.size() > remainingOperators) {
+        opList.resize(remainingOperators);
+        operatorsTruncated = true;
     }
-    return result;
 }
 
 // Checks if the operator is valid, i.e. it has no contradictory preconditions
@@ -10,6 +10,7 @@
 /* disjunctions, etc.                                   */
 /********************************************************/
 
+#include <map>
 #include "../parser/parsedTask.h"
 #include "preprocessedTask.h"
 
@@ -29,29 +30,44 @@ class Preprocess {
 private:
     ParsedTask* task;
     PreprocessedTask* prepTask;
+    std::vector<std::vector<unsigned int>> objectIndex;        // Objects compatible with each type
+    const std::vector<std::vector<unsigned int>>* objectsByType;  // Own index or the one of the main preprocessor
+    std::map<std::vector<unsigned int>, std::vector<unsigned int>> objectsByEitherType;
+    static unsigned int maxOperatorsPerAction;
+    static unsigned int maxThreads;
+    const std::vector<Variable>* opParameters;      // Action whose operators are being built
+    const std::vector<Variable>* opControlVars;
+    std::vector<Variable> noControlVars;
+    unsigned int remainingOperators;                // Operators that the current action can still generate
+    bool operatorsTruncated;
+    unsigned int truncatedActions;
     void preprocessOperators();
+    void preprocessAction(unsigned int index);
+    void preprocessGoal();
     void checkPreconditionFeatures(Precondition &prec, FeatureList* features);
     void checkPreconditionFeatures(DurativeCondition &prec, FeatureList* features);
     void checkGoalFeatures(GoalDescription &goal, FeatureList* features);
     void checkGoalFeatures(DurativeCondition &goal, FeatureList* features);
     void checkEffectFeatures(Effect &eff, FeatureList* features);
     void checkEffectFeatures(DurativeEffect &eff, FeatureList* features);
-    void preprocessAction(Action a, FeatureList* features, bool isGoal);
-    void preprocessAction(DurativeAction a, FeatureList* features, bool isGoal);
+    void preprocessAction(Action &a, FeatureList* features, bool isGoal);
+    void preprocessAction(DurativeAction &a, FeatureList* features, bool isGoal);
     void removeQuantifiers(Precondition &prec, unsigned int numParameters);
     void removeQuantifiers(DurativeCondition &prec, unsigned int numParameters);
     void removeQuantifiers(Effect &eff, unsigned int numParameters);
     void removeQuantifiers(DurativeEffect &eff, unsigned int numParameters);
     void removeQuantifiers(GoalDescription &goal, unsigned int numParameters);
-    void replaceQuantifierParameter(Precondition &prec, Precondition term, 
+    void buildObjectIndex();
+    const std::vector<unsigned int>& getCompatibleObjects(const Variable &param);
+    void replaceQuantifierParameter(Precondition &prec, const Precondition &term, 
         unsigned int paramNumber, unsigned int numParameters);
-    void replaceQuantifierParameter(DurativeCondition &prec, DurativeCondition term, 
+    void replaceQuantifierParameter(DurativeCondition &prec, const DurativeCondition &term, 
         unsigned int paramNumber, unsigned int numParameters);
-    void replaceQuantifierParameter(Effect &eff, Effect term, 
+    void replaceQuantifierParameter(Effect &eff, const Effect &term, 
         unsigned int paramNumber, unsigned int numParameters);
-    void replaceQuantifierParameter(DurativeEffect &eff, DurativeEffect term, 
+    void replaceQuantifierParameter(DurativeEffect &eff, const DurativeEffect &term, 
         unsigned int paramNumber, unsigned int numParameters);
-    void replaceQuantifierParameter(GoalDescription &goal, GoalDescription term, 
+    void replaceQuantifierParameter(GoalDescription &goal, const GoalDescription &term, 
         unsigned int paramNumber, unsigned int numParameters);
     void replaceParameter(Precondition &term, unsigned int paramToReplace, unsigned int objectIndex);   
     void replaceParameter(DurativeCondition &term, unsigned int paramToReplace, unsigned int objectIndex);   
@@ -87,12 +103,12 @@ private:
         GoalDescription *parent, unsigned int termNumber);
     void negationOptimization(GoalDescription *goal, DurativeCondition *parentPrec, 
         GoalDescription *parent, unsigned int termNumber);
-    void removeConditionalEffects(Action a, std::vector<Action> &aList);
-    void removeConditionalEffects(DurativeAction a, std::vector<DurativeAction> &aList);
-    void ignoreConditionalEffect(Action a, std::vector<Action> &aList);
-    void ignoreConditionalEffect(DurativeAction a, std::vector<DurativeAction> &aList);
-    void considerConditionalEffect(Action a, std::vector<Action> &aList);
-    void considerConditionalEffect(DurativeAction a, std::vector<DurativeAction> &aList);
+    void removeConditionalEffects(Action &a, std::vector<Action> &aList);
+    void removeConditionalEffects(DurativeAction &a, std::vector<DurativeAction> &aList);
+    void ignoreConditionalEffect(Action &a, std::vector<Action> &aList);
+    void ignoreConditionalEffect(DurativeAction &a, std::vector<DurativeAction> &aList);
+    void considerConditionalEffect(Action &a, std::vector<Action> &aList);
+    void considerConditionalEffect(DurativeAction &a, std::vector<DurativeAction> &aList);
     bool removeConditionalEffect(Effect *eff, Effect *parent, int numTerm, Action &a);
     bool removeConditionalEffect(DurativeEffect *eff, DurativeEffect *parent, int numTerm, DurativeAction &a);
     bool manageConditionalEffect(Effect *eff, Effect *parent, int numTerm, Action &a);
@@ -101,14 +117,18 @@ private:
     bool existingConditionalEffects(DurativeEffect &eff);
     void buildOperators(Action &a, bool isGoal);
     void buildOperators(DurativeAction &a, bool isGoal);
-    std::vector<Operator> buildOperatorPrecondition(Precondition &prec, Action &a, Operator *op);
-    std::vector<Operator> buildOperatorPrecondition(DurativeCondition &prec, DurativeAction &a, Operator *op);
-    std::vector<Operator> buildOperatorPrecondition(GoalDescription &goal, Action &a, Operator *op);
-    std::vector<Operator> buildOperatorPrecondition(GoalDescription &goal, DurativeAction &a, Operator *op);
-    std::vector<Operator> buildOperatorPreconditionAnd(Precondition &prec, Action &a, Operator *op, unsigned int numTerm);
-    std::vector<Operator> buildOperatorPreconditionAnd(DurativeCondition &prec, DurativeAction &a, Operator *op, unsigned int numTerm);
-    std::vector<Operator> buildOperatorPreconditionAnd(GoalDescription &goal, Action &a, Operator *op, unsigned int numTerm);
-    std::vector<Operator> buildOperatorPreconditionAnd(GoalDescription &goal, DurativeAction &a, Operator *op, unsigned int numTerm);
+    void startBuildingOperators(const std::vector<Variable> &parameters, const std::vector<Variable> &controlVars);
+    void buildOperatorDisjunction(std::vector<Precondition> &terms, Action &a, std::vector<Operator> &opList);
+    void buildOperatorDisjunction(std::vector<GoalDescription> &terms, Action &a, std::vector<Operator> &opList);
+    void buildOperatorDisjunction(std::vector<GoalDescription> &terms, DurativeAction &a, std::vector<Operator> &opList);
+    void buildOperatorPrecondition(Precondition &prec, Action &a, std::vector<Operator> &opList);
+    void buildOperatorPrecondition(DurativeCondition &prec, DurativeAction &a, std::vector<Operator> &opList);
+    void buildOperatorPrecondition(GoalDescription &goal, Action &a, std::vector<Operator> &opList);
+    void buildOperatorPrecondition(GoalDescription &goal, DurativeAction &a, std::vector<Operator> &opList);
+    bool consistentOperator(Operator &op);
+    bool consistentPreconditions(unsigned int paramValues[], std::vector<OpFluent> &precs);
+    void getOperatorKey(Operator &op, std::vector<std::string> &key);
+    void reduceOperators(std::vector<Operator> &opList, bool complete);
     bool checkValidOperator(Operator &op, unsigned int numParameters);
     bool setParameterValues(unsigned int paramValues[], unsigned int equivalences[], const std::vector<OpEquality> &equality);
     bool checkEqualities(unsigned int paramValues[], unsigned int equivalences[], 
@@ -126,6 +146,11 @@ public:
     Preprocess();
     ~Preprocess();
     PreprocessedTask* preprocessTask(ParsedTask* parsedTask);
+    PreprocessedTask* preprocessProblemGoal(ParsedTask* parsedTask);
+    bool objectDependentOperators(ParsedTask* parsedTask);
+    static void setMaxOperatorsPerAction(unsigned int max) { maxOperatorsPerAction = max; }
+    static unsigned int getMaxOperatorsPerAction() { return maxOperatorsPerAction; }
+    static void setMaxThreads(unsigned int max) { maxThreads = max; }
 };
 
 #endif
@@ -55,6 +55,12 @@ string OpFluent::toString(const vector<Function> &functions, const vector<Object
 /* CLASS: OpEffectExpression                            */
 /********************************************************/
 
+// Creates an empty expression (filled by the snapshot loader)
+OpEffectExpression::OpEffectExpression() {
+    type = OEET_NUMBER;
+    value = 0;
+}
+
 OpEffectExpression::OpEffectExpression(EffectExpression &exp) {
     switch (exp.type) {
     case EE_NUMBER:
@@ -165,6 +171,11 @@ string OpEffectExpression::toString(const vector<Function> &functions, const vec
 /* CLASS: OpEffect                                      */
 /********************************************************/
 
+// Creates an empty effect (filled by the snapshot loader)
+OpEffect::OpEffect() {
+    assignment = AS_ASSIGN;
+}
+
 OpEffect::OpEffect(FluentAssignment &f) : exp(f.exp) {
     assignment = f.type;
     fluent = f.fluent;
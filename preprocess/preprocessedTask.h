@@ -84,6 +84,7 @@ public:
     std::vector<OpEffectExpression> operands;   // if type == OEET_SHARP_T_PRODUCT | OEET_SUM | OEET_SUB | OEET_DIV | OEET_MUL
     Literal fluent;                             // if type == OEET_FLUENT
     Term term;                                  // if type == OEET_TERM
+    OpEffectExpression();
     OpEffectExpression(EffectExpression& exp);
     OpEffectExpression(ContinuousEffect& exp);
     OpEffectExpression(NumericExpression& exp);
@@ -96,6 +97,7 @@ public:
     Assignment assignment;
     Literal fluent;
     OpEffectExpression exp;
+    OpEffect();
     OpEffect(FluentAssignment& f);
     OpEffect(AssignmentContinuousEffect& f);
     std::string toString(const std::vector<Function>& functions, const std::vector<Object>& objects, 
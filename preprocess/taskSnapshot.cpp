@@ -0,0 +1,554 @@
+/********************************************************/
+/* Versioned binary snapshot of a preprocessed task:    */
+/* types, objects, functions, initial state and the     */
+/* operators (the goal is stored as the goal operator). */
+/* Loading a snapshot replaces parsing and preprocess.  */
+/********************************************************/
+
+#include "taskSnapshot.h"
+#include "../utils/profiler.h"
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+// File header
+const char SNAPSHOT_MAGIC[4] = { 'P', 'F', 'E', 'S' };
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t payloadLength;
+    uint64_t checksum;
+};
+
+// Creates a snapshot reader/writer for the given file
+TaskSnapshot::TaskSnapshot(const char* fileName) {
+    this->fileName = fileName;
+    buffer = nullptr;
+    bufferLength = 0;
+    position = 0;
+}
+
+// FNV-1a hash computed on 8-byte words, so that checking large snapshots is not slower
+// than reading them
+uint64_t TaskSnapshot::checksum(const char* data, size_t length) {
+    uint64_t h = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * 1099511628211ULL;
+    }
+    for (; i < length; i++)
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ULL;
+    return h;
+}
+
+/********************************************************/
+/* Writing                                              */
+/********************************************************/
+
+// Saves a preprocessed task (and its parsed task) in a snapshot file. Throws a ParseError
+// if the file cannot be written
+void TaskSnapshot::save(PreprocessedTask* prepTask, const char* fileName) {
+    ProfileScope profile("saveSnapshot");
+    TaskSnapshot snapshot(fileName);
+    snapshot.writeParsedTask(prepTask->task);
+    snapshot.writeInt((int32_t)prepTask->operators.size());
+    for (Operator& op : prepTask->operators)
+        snapshot.writeOperator(op);
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.payloadLength = snapshot.data.length();
+    header.checksum = checksum(snapshot.data.c_str(), snapshot.data.length());
+    ofstream out(fileName, ios::binary);
+    if (out.is_open()) {
+        out.write((const char*)&header, sizeof(header));
+        out.write(snapshot.data.c_str(), snapshot.data.length());
+        out.close();
+    }
+    if (!out.good())
+        throw ParseError(1, "Cannot write the snapshot file: " + string(fileName));
+    profile.count("bytes", sizeof(header) + snapshot.data.length());
+}
+
+// Writes the data of the parsed task used after the preprocess. The actions, constraints,
+// metric and goal description are not stored, as they are already compiled into the operators
+void TaskSnapshot::writeParsedTask(ParsedTask* task) {
+    writeString(task->domainName);
+    writeString(task->problemName);
+    writeInt((int32_t)task->requirements.size());
+    for (string& r : task->requirements)
+        writeString(r);
+    writeInt((int32_t)task->BOOLEAN_TYPE);
+    writeInt((int32_t)task->NUMBER_TYPE);
+    writeInt((int32_t)task->INTEGER_TYPE);
+    writeInt((int32_t)task->CONSTANT_FALSE);
+    writeInt((int32_t)task->CONSTANT_TRUE);
+    writeInt((int32_t)task->types.size());
+    for (Type& t : task->types) {
+        writeString(t.name);
+        writeUnsignedVector(t.parentTypes);
+    }
+    writeInt((int32_t)task->objects.size());
+    for (Object& o : task->objects) {
+        writeString(o.name);
+        writeInt(o.isConstant ? 1 : 0);
+        writeUnsignedVector(o.types);
+    }
+    writeInt((int32_t)task->functions.size());
+    for (Function& f : task->functions) {
+        writeString(f.name);
+        writeVariables(f.parameters);
+        writeUnsignedVector(f.valueTypes);
+    }
+    writeUnsignedVector(task->initAtoms.functions);
+    writeUnsignedVector(task->initAtoms.firstArgument);
+    writeUnsignedVector(task->initAtoms.arguments);
+    writeInt((int32_t)task->init.size());
+    for (Fact& f : task->init) {
+        writeInt(f.valueIsNumeric ? 1 : 0);
+        writeInt((int32_t)f.function);
+        writeInt((int32_t)f.value);
+        writeFloat(f.numericValue);
+        writeFloat(f.time);
+        writeUnsignedVector(f.parameters);
+    }
+}
+
+// Writes an integer
+void TaskSnapshot::writeInt(int32_t value) {
+    data.append((const char*)&value, sizeof(value));
+}
+
+// Writes a real number
+void TaskSnapshot::writeFloat(float value) {
+    data.append((const char*)&value, sizeof(value));
+}
+
+// Writes a string: length and characters
+void TaskSnapshot::writeString(const string& s) {
+    writeInt((int32_t)s.length());
+    data.append(s);
+}
+
+// Writes a vector of unsigned integers as a single block
+void TaskSnapshot::writeUnsignedVector(const vector<unsigned int>& v) {
+    writeInt((int32_t)v.size());
+    data.append((const char*)v.data(), v.size() * sizeof(unsigned int));
+}
+
+// Writes a term
+void TaskSnapshot::writeTerm(const Term& t) {
+    writeInt(t.type);
+    writeInt((int32_t)t.index);
+}
+
+// Writes a list of terms
+void TaskSnapshot::writeTerms(const vector<Term>& v) {
+    writeInt((int32_t)v.size());
+    for (const Term& t : v)
+        writeTerm(t);
+}
+
+// Writes a literal
+void TaskSnapshot::writeLiteral(const Literal& l) {
+    writeInt((int32_t)l.fncIndex);
+    writeTerms(l.params);
+}
+
+// Writes a list of variables
+void TaskSnapshot::writeVariables(const vector<Variable>& v) {
+    writeInt((int32_t)v.size());
+    for (const Variable& var : v) {
+        writeString(var.name);
+        writeUnsignedVector(var.types);
+    }
+}
+
+// Writes a numeric expression
+void TaskSnapshot::writeNumericExpression(const NumericExpression& exp) {
+    writeInt(exp.type);
+    writeFloat(exp.value);
+    writeLiteral(exp.function);
+    writeTerm(exp.term);
+    writeInt((int32_t)exp.operands.size());
+    for (const NumericExpression& op : exp.operands)
+        writeNumericExpression(op);
+}
+
+// Writes a goal description (used in the preferences of the operators)
+void TaskSnapshot::writeGoalDescription(const GoalDescription& goal) {
+    writeInt(goal.time);
+    writeInt(goal.type);
+    writeLiteral(goal.literal);
+    writeInt((int32_t)goal.terms.size());
+    for (const GoalDescription& term : goal.terms)
+        writeGoalDescription(term);
+    writeVariables(goal.parameters);
+    writeInt(goal.comparator);
+    writeInt((int32_t)goal.exp.size());
+    for (const NumericExpression& exp : goal.exp)
+        writeNumericExpression(exp);
+    writeTerms(goal.eqTerms);
+}
+
+// Writes a list of operator fluents
+void TaskSnapshot::writeOpFluents(const vector<OpFluent>& v) {
+    writeInt((int32_t)v.size());
+    for (const OpFluent& f : v) {
+        writeLiteral(f.variable);
+        writeTerm(f.value);
+    }
+}
+
+// Writes a numeric expression of an operator
+void TaskSnapshot::writeOpEffectExpression(const OpEffectExpression& exp) {
+    writeInt(exp.type);
+    writeFloat(exp.value);
+    writeInt((int32_t)exp.operands.size());
+    for (const OpEffectExpression& op : exp.operands)
+        writeOpEffectExpression(op);
+    writeLiteral(exp.fluent);
+    writeTerm(exp.term);
+}
+
+// Writes a list of numeric preconditions
+void TaskSnapshot::writeOpNumericPrecs(const vector<OpNumericPrec>& v) {
+    writeInt((int32_t)v.size());
+    for (const OpNumericPrec& prec : v) {
+        writeInt(prec.comparator);
+        writeInt((int32_t)prec.operands.size());
+        for (const OpEffectExpression& exp : prec.operands)
+            writeOpEffectExpression(exp);
+    }
+}
+
+// Writes the conditions and effects of an operator at a time point
+void TaskSnapshot::writeOpCondition(const OpCondition& c) {
+    writeOpFluents(c.prec);
+    writeOpNumericPrecs(c.numericPrec);
+    writeOpFluents(c.eff);
+    writeInt((int32_t)c.numericEff.size());
+    for (const OpEffect& eff : c.numericEff) {
+        writeInt(eff.assignment);
+        writeLiteral(eff.fluent);
+        writeOpEffectExpression(eff.exp);
+    }
+}
+
+// Writes an operator
+void TaskSnapshot::writeOperator(const Operator& op) {
+    writeString(op.name);
+    writeVariables(op.parameters);
+    writeVariables(op.controlVars);
+    writeInt((int32_t)op.duration.size());
+    for (const Duration& d : op.duration) {
+        writeInt(d.time);
+        writeInt(d.comp);
+        writeNumericExpression(d.exp);
+    }
+    writeOpCondition(op.atStart);
+    writeOpCondition(op.atEnd);
+    writeOpFluents(op.overAllPrec);
+    writeOpNumericPrecs(op.overAllNumericPrec);
+    writeInt((int32_t)op.equality.size());
+    for (const OpEquality& eq : op.equality) {
+        writeInt(eq.equal ? 1 : 0);
+        writeTerm(eq.value1);
+        writeTerm(eq.value2);
+    }
+    writeInt((int32_t)op.preference.size());
+    for (const OpPreference& pref : op.preference) {
+        writeString(pref.name);
+        writeGoalDescription(pref.preference);
+    }
+    writeInt(op.isGoal ? 1 : 0);
+}
+
+/********************************************************/
+/* Reading                                              */
+/********************************************************/
+
+// Loads a preprocessed task from a snapshot file. The file is memory-mapped and its
+// checksum verified. Throws a ParseError if the file does not exist or is not a valid
+// snapshot. The names of the loaded task are not indexed, so it cannot be used to parse
+// more files
+PreprocessedTask* TaskSnapshot::load(const char* fileName) {
+    ProfileScope profile("loadSnapshot");
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) throw ParseError(1, "File not found: " + string(fileName));
+    struct stat st;
+    size_t fileLength = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+    void* map = fileLength >= sizeof(SnapshotHeader) ?
+        mmap(nullptr, fileLength, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) throw ParseError(2, "Invalid snapshot file: " + string(fileName));
+    madvise(map, fileLength, MADV_SEQUENTIAL);
+    TaskSnapshot snapshot(fileName);
+    SnapshotHeader header;
+    memcpy(&header, map, sizeof(header));
+    snapshot.buffer = (const char*)map + sizeof(header);
+    snapshot.bufferLength = fileLength - sizeof(header);
+    ParsedTask* task = new ParsedTask();
+    PreprocessedTask* prepTask = new PreprocessedTask(task);
+    try {
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SNAPSHOT_VERSION || header.payloadLength != snapshot.bufferLength ||
+            header.checksum != checksum(snapshot.buffer, snapshot.bufferLength))
+            snapshot.invalidFile();
+        snapshot.readParsedTask(task);
+        int32_t numOperators = snapshot.readCount();
+        prepTask->operators.resize(numOperators);
+        for (Operator& op : prepTask->operators)
+            snapshot.readOperator(op);
+        if (snapshot.position != snapshot.bufferLength) snapshot.invalidFile();
+    }
+    catch (ParseError& e) {
+        munmap(map, fileLength);
+        delete prepTask;
+        delete task;
+        throw;
+    }
+    munmap(map, fileLength);
+    profile.count("bytes", fileLength);
+    profile.count("objects", task->objects.size());
+    profile.count("operators", prepTask->operators.size());
+    return prepTask;
+}
+
+// Reads the data of the parsed task
+void TaskSnapshot::readParsedTask(ParsedTask* task) {
+    task->domainName = readString();
+    task->problemName = readString();
+    task->requirements.resize(readCount());
+    for (string& r : task->requirements)
+        r = readString();
+    task->BOOLEAN_TYPE = (unsigned int)readInt();
+    task->NUMBER_TYPE = (unsigned int)readInt();
+    task->INTEGER_TYPE = (unsigned int)readInt();
+    task->CONSTANT_FALSE = (unsigned int)readInt();
+    task->CONSTANT_TRUE = (unsigned int)readInt();
+    int32_t numTypes = readCount();
+    task->types.reserve(numTypes);
+    for (int32_t i = 0; i < numTypes; i++) {
+        task->types.emplace_back(i, readString());
+        readUnsignedVector(task->types.back().parentTypes);
+    }
+    int32_t numObjects = readCount();
+    task->objects.reserve(numObjects);
+    for (int32_t i = 0; i < numObjects; i++) {
+        string name = readString();
+        task->objects.emplace_back(i, name, readInt() != 0);
+        readUnsignedVector(task->objects.back().types);
+    }
+    task->functions.resize(readCount());
+    for (unsigned int i = 0; i < task->functions.size(); i++) {
+        Function& f = task->functions[i];
+        f.index = i;
+        f.name = readString();
+        readVariables(f.parameters);
+        readUnsignedVector(f.valueTypes);
+    }
+    readUnsignedVector(task->initAtoms.functions);
+    readUnsignedVector(task->initAtoms.firstArgument);
+    readUnsignedVector(task->initAtoms.arguments);
+    if (task->initAtoms.firstArgument.size() != task->initAtoms.functions.size() + 1) invalidFile();
+    task->init.resize(readCount());
+    for (Fact& f : task->init) {
+        f.valueIsNumeric = readInt() != 0;
+        f.function = (unsigned int)readInt();
+        f.value = (unsigned int)readInt();
+        f.numericValue = readFloat();
+        f.time = readFloat();
+        readUnsignedVector(f.parameters);
+    }
+}
+
+// Raises an error for a corrupted or incompatible snapshot
+void TaskSnapshot::invalidFile() {
+    throw ParseError(2, "Invalid snapshot file: " + fileName);
+}
+
+// Copies the next bytes of the snapshot
+void TaskSnapshot::readBytes(void* dest, size_t length) {
+    if (length > bufferLength - position) invalidFile();
+    memcpy(dest, buffer + position, length);
+    position += length;
+}
+
+// Reads an integer
+int32_t TaskSnapshot::readInt() {
+    int32_t value;
+    readBytes(&value, sizeof(value));
+    return value;
+}
+
+// Reads the number of elements of a list
+int32_t TaskSnapshot::readCount() {
+    int32_t value = readInt();
+    if (value < 0 || (size_t)value > bufferLength - position) invalidFile();
+    return value;
+}
+
+// Reads a real number
+float TaskSnapshot::readFloat() {
+    float value;
+    readBytes(&value, sizeof(value));
+    return value;
+}
+
+// Reads a string
+string TaskSnapshot::readString() {
+    int32_t length = readCount();
+    string s(buffer + position, length);
+    position += length;
+    return s;
+}
+
+// Reads a vector of unsigned integers stored as a single block
+void TaskSnapshot::readUnsignedVector(vector<unsigned int>& v) {
+    int32_t size = readCount();
+    v.resize(size);
+    readBytes(v.data(), size * sizeof(unsigned int));
+}
+
+// Reads a term
+void TaskSnapshot::readTerm(Term& t) {
+    t.type = (TermType)readInt();
+    t.index = (unsigned int)readInt();
+}
+
+// Reads a list of terms
+void TaskSnapshot::readTerms(vector<Term>& v) {
+    v.resize(readCount());
+    for (Term& t : v)
+        readTerm(t);
+}
+
+// Reads a literal
+void TaskSnapshot::readLiteral(Literal& l) {
+    l.fncIndex = (unsigned int)readInt();
+    readTerms(l.params);
+}
+
+// Reads a list of variables
+void TaskSnapshot::readVariables(vector<Variable>& v) {
+    int32_t size = readCount();
+    v.reserve(size);
+    vector<unsigned int> types;
+    for (int32_t i = 0; i < size; i++) {
+        string name = readString();
+        readUnsignedVector(types);
+        v.emplace_back(name, types);
+    }
+}
+
+// Reads a numeric expression
+void TaskSnapshot::readNumericExpression(NumericExpression& exp) {
+    exp.type = (NumericExpressionType)readInt();
+    exp.value = readFloat();
+    readLiteral(exp.function);
+    readTerm(exp.term);
+    exp.operands.resize(readCount());
+    for (NumericExpression& op : exp.operands)
+        readNumericExpression(op);
+}
+
+// Reads a goal description
+void TaskSnapshot::readGoalDescription(GoalDescription& goal) {
+    goal.time = (TimeSpecifier)readInt();
+    goal.type = (GoalDescriptionType)readInt();
+    readLiteral(goal.literal);
+    goal.terms.resize(readCount());
+    for (GoalDescription& term : goal.terms)
+        readGoalDescription(term);
+    readVariables(goal.parameters);
+    goal.comparator = (Comparator)readInt();
+    goal.exp.resize(readCount());
+    for (NumericExpression& exp : goal.exp)
+        readNumericExpression(exp);
+    readTerms(goal.eqTerms);
+}
+
+// Reads a list of operator fluents
+void TaskSnapshot::readOpFluents(vector<OpFluent>& v) {
+    v.resize(readCount());
+    for (OpFluent& f : v) {
+        readLiteral(f.variable);
+        readTerm(f.value);
+    }
+}
+
+// Reads a numeric expression of an operator
+void TaskSnapshot::readOpEffectExpression(OpEffectExpression& exp) {
+    exp.type = (OpEffectExpressionType)readInt();
+    exp.value = readFloat();
+    exp.operands.resize(readCount());
+    for (OpEffectExpression& op : exp.operands)
+        readOpEffectExpression(op);
+    readLiteral(exp.fluent);
+    readTerm(exp.term);
+}
+
+// Reads a list of numeric preconditions
+void TaskSnapshot::readOpNumericPrecs(vector<OpNumericPrec>& v) {
+    v.resize(readCount());
+    for (OpNumericPrec& prec : v) {
+        prec.comparator = (Comparator)readInt();
+        prec.operands.resize(readCount());
+        for (OpEffectExpression& exp : prec.operands)
+            readOpEffectExpression(exp);
+    }
+}
+
+// Reads the conditions and effects of an operator at a time point
+void TaskSnapshot::readOpCondition(OpCondition& c) {
+    readOpFluents(c.prec);
+    readOpNumericPrecs(c.numericPrec);
+    readOpFluents(c.eff);
+    c.numericEff.resize(readCount());
+    for (OpEffect& eff : c.numericEff) {
+        eff.assignment = (Assignment)readInt();
+        readLiteral(eff.fluent);
+        readOpEffectExpression(eff.exp);
+    }
+}
+
+// Reads an operator
+void TaskSnapshot::readOperator(Operator& op) {
+    op.name = readString();
+    readVariables(op.parameters);
+    readVariables(op.controlVars);
+    int32_t numDurations = readCount();
+    for (int32_t i = 0; i < numDurations; i++) {
+        op.duration.emplace_back(Symbol::EQUAL, NumericExpression());
+        Duration& d = op.duration.back();
+        d.time = (TimeSpecifier)readInt();
+        d.comp = (Comparator)readInt();
+        readNumericExpression(d.exp);
+    }
+    readOpCondition(op.atStart);
+    readOpCondition(op.atEnd);
+    readOpFluents(op.overAllPrec);
+    readOpNumericPrecs(op.overAllNumericPrec);
+    op.equality.resize(readCount());
+    for (OpEquality& eq : op.equality) {
+        eq.equal = readInt() != 0;
+        readTerm(eq.value1);
+        readTerm(eq.value2);
+    }
+    op.preference.resize(readCount());
+    for (OpPreference& pref : op.preference) {
+        pref.name = readString();
+        readGoalDescription(pref.preference);
+    }
+    op.isGoal = readInt() != 0;
+}
@@ -0,0 +1,67 @@
+#ifndef TASK_SNAPSHOT_H
+#define TASK_SNAPSHOT_H
+
+/********************************************************/
+/* Versioned binary snapshot of a preprocessed task:    */
+/* types, objects, functions, initial state and the     */
+/* operators (the goal is stored as the goal operator). */
+/* Loading a snapshot replaces parsing and preprocess.  */
+/********************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "preprocessedTask.h"
+
+class TaskSnapshot {
+private:
+    std::string fileName;
+    std::string data;           // Used for writing
+    const char* buffer;         // Used for reading (memory-mapped file)
+    size_t bufferLength;
+    size_t position;
+
+    TaskSnapshot(const char* fileName);
+    static uint64_t checksum(const char* data, size_t length);
+    void writeInt(int32_t value);
+    void writeFloat(float value);
+    void writeString(const std::string& s);
+    void writeUnsignedVector(const std::vector<unsigned int>& v);
+    void writeTerm(const Term& t);
+    void writeTerms(const std::vector<Term>& v);
+    void writeLiteral(const Literal& l);
+    void writeVariables(const std::vector<Variable>& v);
+    void writeNumericExpression(const NumericExpression& exp);
+    void writeGoalDescription(const GoalDescription& goal);
+    void writeOpFluents(const std::vector<OpFluent>& v);
+    void writeOpEffectExpression(const OpEffectExpression& exp);
+    void writeOpNumericPrecs(const std::vector<OpNumericPrec>& v);
+    void writeOpCondition(const OpCondition& c);
+    void writeOperator(const Operator& op);
+    void writeParsedTask(ParsedTask* task);
+    void invalidFile();
+    void readBytes(void* dest, size_t length);
+    int32_t readInt();
+    int32_t readCount();
+    float readFloat();
+    std::string readString();
+    void readUnsignedVector(std::vector<unsigned int>& v);
+    void readTerm(Term& t);
+    void readTerms(std::vector<Term>& v);
+    void readLiteral(Literal& l);
+    void readVariables(std::vector<Variable>& v);
+    void readNumericExpression(NumericExpression& exp);
+    void readGoalDescription(GoalDescription& goal);
+    void readOpFluents(std::vector<OpFluent>& v);
+    void readOpEffectExpression(OpEffectExpression& exp);
+    void readOpNumericPrecs(std::vector<OpNumericPrec>& v);
+    void readOpCondition(OpCondition& c);
+    void readOperator(Operator& op);
+    void readParsedTask(ParsedTask* task);
+
+public:
+    static void save(PreprocessedTask* prepTask, const char* fileName);
+    static PreprocessedTask* load(const char* fileName);
+};
+
+#endif
@@ -0,0 +1,210 @@
+/********************************************************/
+/* Server that keeps the analysis of one or more        */
+/* domains in memory and classifies the objects of the  */
+/* problems received through a Unix domain socket.      */
+/********************************************************/
+
+#include "classificationServer.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <unistd.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+using namespace std;
+
+// Maximum length of a request
+const uint32_t MAX_REQUEST_LENGTH = 65536;
+
+// Seconds a client can stay idle before its connection is closed
+const int CLIENT_TIMEOUT = 300;
+
+// Creates a server that will listen in the given socket path
+ClassificationServer::ClassificationServer(const char* socketPath)
+{
+	this->socketPath = socketPath;
+	activeClients = 0;
+}
+
+// Disposes the server and the loaded domains
+ClassificationServer::~ClassificationServer()
+{
+	for (Classifier* c : domains)
+		delete c;
+}
+
+// Parses and analyses a domain, using the given cache directory if it is not nullptr.
+// Throws a ParseError if the domain file cannot be parsed
+void ClassificationServer::addDomain(char* domainFileName, const char* cacheDir)
+{
+	domains.push_back(new Classifier(domainFileName, cacheDir));
+}
+
+// Returns the loaded domain with the given name, or nullptr if it does not exist
+Classifier* ClassificationServer::findDomain(const string& name)
+{
+	for (Classifier* c : domains)
+		if (c->getDomainName() == name)
+			return c;
+	return nullptr;
+}
+
+// Listens for connections until the process is terminated. Each client is attended by
+// its own thread, so a slow or idle client does not delay the others, and can send
+// several requests through the same connection. Returns false if the server cannot
+// listen in the socket or stops accepting connections because of an error
+bool ClassificationServer::run()
+{
+	sockaddr_un address;
+	if (socketPath.length() >= sizeof(address.sun_path)) {
+		cerr << "Socket path too long: " << socketPath << endl;
+		return false;
+	}
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0) {
+		cerr << "Unable to create the socket: " << strerror(errno) << endl;
+		return false;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath.c_str());
+	unlink(socketPath.c_str());
+	if (bind(server, (sockaddr*)&address, sizeof(address)) < 0 || listen(server, SOMAXCONN) < 0) {
+		cerr << "Unable to listen in " << socketPath << ": " << strerror(errno) << endl;
+		close(server);
+		return false;
+	}
+	cerr << "Listening in " << socketPath << endl;
+	while (true) {
+		int client = accept(server, nullptr, nullptr);
+		if (client < 0) {
+			if (errno == EINTR) continue;
+			cerr << "Unable to accept a connection: " << strerror(errno) << endl;
+			break;
+		}
+		startClient(client);
+	}
+	close(server);
+	unlink(socketPath.c_str());
+	unique_lock<mutex> guard(clientsLock);
+	clientsFinished.wait(guard, [this] { return activeClients == 0; });
+	return false;
+}
+
+// Starts a thread that attends the client and closes the connection when it finishes.
+// The connection is closed if the client does not send anything in CLIENT_TIMEOUT seconds
+void ClassificationServer::startClient(int client)
+{
+	timeval timeout = { CLIENT_TIMEOUT, 0 };
+	setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	{
+		lock_guard<mutex> guard(clientsLock);
+		activeClients++;
+	}
+	try {
+		thread([this, client] {
+			attendClient(client);
+			close(client);
+			lock_guard<mutex> guard(clientsLock);
+			activeClients--;
+			clientsFinished.notify_all();
+		}).detach();
+	}
+	catch (system_error& e) {
+		cerr << "Unable to attend a connection: " << e.what() << endl;
+		close(client);
+		lock_guard<mutex> guard(clientsLock);
+		activeClients--;
+	}
+}
+
+// Answers the requests of a client until it closes the connection
+void ClassificationServer::attendClient(int client)
+{
+	string request;
+	while (readMessage(client, request)) {
+		if (!writeMessage(client, processRequest(request)))
+			break;
+	}
+}
+
+// Classifies the problem given in the request and returns the response
+string ClassificationServer::processRequest(const string& request)
+{
+	Classifier* classifier;
+	string problemFileName;
+	size_t endOfLine = request.find('\n');
+	if (endOfLine == string::npos) {
+		if (domains.size() != 1) return "error\nDomain name expected";
+		classifier = domains[0];
+		problemFileName = request;
+	}
+	else {
+		string domainName = request.substr(0, endOfLine);
+		classifier = findDomain(domainName);
+		if (classifier == nullptr) return "error\nDomain not loaded: " + domainName;
+		problemFileName = request.substr(endOfLine + 1);
+	}
+	ostringstream out;
+	try {
+		classifier->classify((char*)problemFileName.c_str(), out);
+	}
+	catch (ParseError& e) {
+		return "error\n" + string(e.what());
+	}
+	catch (exception& e) {
+		return "error\nUnable to classify " + problemFileName + ": " + e.what();
+	}
+	return "ok\n" + out.str();
+}
+
+// Reads a message. Returns false if the connection has been closed
+bool ClassificationServer::readMessage(int client, string& message)
+{
+	uint32_t length;
+	if (!readBytes(client, (char*)&length, sizeof(length)))
+		return false;
+	length = ntohl(length);
+	if (length > MAX_REQUEST_LENGTH)
+		return false;
+	message.resize(length);
+	return length == 0 || readBytes(client, &message[0], length);
+}
+
+// Writes a message. Returns false if the connection has been closed
+bool ClassificationServer::writeMessage(int client, const string& message)
+{
+	uint32_t length = htonl((uint32_t)message.length());
+	return writeBytes(client, (const char*)&length, sizeof(length)) &&
+		writeBytes(client, message.c_str(), message.length());
+}
+
+// Reads the given number of bytes
+bool ClassificationServer::readBytes(int client, char* data, size_t length)
+{
+	while (length > 0) {
+		ssize_t n = recv(client, data, length, 0);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		data += n;
+		length -= n;
+	}
+	return true;
+}
+
+// Writes the given number of bytes
+bool ClassificationServer::writeBytes(int client, const char* data, size_t length)
+{
+	while (length > 0) {
+		ssize_t n = send(client, data, length, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		data += n;
+		length -= n;
+	}
+	return true;
+}
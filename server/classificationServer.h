@@ -0,0 +1,47 @@
+#ifndef CLASSIFICATION_SERVER_H
+#define CLASSIFICATION_SERVER_H
+
+/********************************************************/
+/* Server that keeps the analysis of one or more        */
+/* domains in memory and classifies the objects of the  */
+/* problems received through a Unix domain socket.      */
+/*                                                      */
+/* Protocol: every message (request or response) is a   */
+/* 4-byte length, in network byte order, followed by    */
+/* the payload.                                         */
+/*   Request:  <domain_name>\n<problem_file>            */
+/*             (or only <problem_file> if a single      */
+/*              domain is loaded)                       */
+/*   Response: ok\n<json> | error\n<message>            */
+/********************************************************/
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "../stages/classifier.h"
+
+class ClassificationServer {
+private:
+	std::string socketPath;
+	std::vector<Classifier*> domains;
+	int activeClients;					// Connections being attended
+	std::mutex clientsLock;
+	std::condition_variable clientsFinished;
+	Classifier* findDomain(const std::string& name);
+	void attendClient(int client);
+	void startClient(int client);
+	std::string processRequest(const std::string& request);
+	bool readMessage(int client, std::string& message);
+	bool writeMessage(int client, const std::string& message);
+	bool readBytes(int client, char* data, size_t length);
+	bool writeBytes(int client, const char* data, size_t length);
+
+public:
+	ClassificationServer(const char* socketPath);
+	~ClassificationServer();
+	void addDomain(char* domainFileName, const char* cacheDir);
+	bool run();
+};
+
+#endif // !#ifndef CLASSIFICATION_SERVER_H
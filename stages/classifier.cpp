@@ -0,0 +1,169 @@
+/********************************************************/
+/* Classifies the objects of several problems of the    */
+/* same domain, analysing the domain only once.         */
+/********************************************************/
+
+#include "classifier.h"
+#include "../parser/parser.h"
+#include "../preprocess/preprocess.h"
+#include "../utils/workStealingPool.h"
+#include "stagesCache.h"
+#include <sstream>
+#include <memory>
+#include <condition_variable>
+using namespace std;
+
+// Parses and analyses the domain. If a cache directory is given, the domain analysis is
+// loaded from (or saved to) the cache
+Classifier::Classifier(char* domainFileName, const char* cacheDir)
+{
+	Parser parser;
+	parsedDomain = parser.parseDomain(domainFileName);
+	this->cacheDir = cacheDir != nullptr ? cacheDir : "";
+	prepDomain = nullptr;
+	domainTask = nullptr;
+	domainStages = nullptr;
+	Preprocess preprocess;
+	sharedAnalysis = !preprocess.objectDependentOperators(parsedDomain);
+	if (sharedAnalysis) {
+		analyseDomain();
+	}
+}
+
+// Disposes the domain data
+Classifier::~Classifier()
+{
+	if (domainStages != nullptr) delete domainStages;
+	if (domainTask != nullptr) delete domainTask;
+	if (prepDomain != nullptr) delete prepDomain;
+	delete parsedDomain;
+}
+
+// Computes the stages of the domain
+void Classifier::analyseDomain()
+{
+	Preprocess preprocess;
+	prepDomain = preprocess.preprocessTask(parsedDomain);
+	domainTask = new Task(prepDomain);
+	if (cacheDir.empty()) {
+		domainStages = new Stages(domainTask);
+	}
+	else {
+		StagesCache cache(cacheDir.c_str(), parsedDomain);
+		domainStages = cache.load(domainTask);
+		if (domainStages == nullptr) {
+			domainStages = new Stages(domainTask);
+			cache.save(domainStages);
+		}
+	}
+}
+
+// Prints the domain features and stages
+void Classifier::toJSON()
+{
+	if (domainStages == nullptr) analyseDomain();
+	domainStages->toJSON();
+}
+
+// Classifies the objects of a problem of the domain and writes the result in the
+// given stream. Throws a ParseError if the problem file cannot be parsed
+void Classifier::classify(char* problemFileName, ostream& out)
+{
+	vector<ObjectClassification> objects;
+	classify(problemFileName, objects);
+	Stages::toJSON(objects, out);
+}
+
+// Classifies the objects of a problem of the domain. Throws a ParseError if the problem
+// file cannot be parsed
+void Classifier::classify(char* problemFileName, vector<ObjectClassification>& objects)
+{
+	Parser parser;
+	unique_ptr<ParsedTask> parsedTask(new ParsedTask(*parsedDomain));
+	parser.parseProblem(problemFileName, parsedTask.get());
+	classifyParsedProblem(parsedTask.get(), objects);
+}
+
+// Classifies the objects of a problem stored in a memory buffer. Throws a ParseError if
+// the problem cannot be parsed
+void Classifier::classify(const char* problemName, const char* buffer, size_t length,
+	vector<ObjectClassification>& objects)
+{
+	Parser parser;
+	unique_ptr<ParsedTask> parsedTask(new ParsedTask(*parsedDomain));
+	parser.parseProblem(problemName, buffer, length, parsedTask.get());
+	classifyParsedProblem(parsedTask.get(), objects);
+}
+
+// Classifies the objects of a parsed problem
+void Classifier::classifyParsedProblem(ParsedTask* parsedTask, vector<ObjectClassification>& objects)
+{
+	if (sharedAnalysis && parsedTask->types.size() == parsedDomain->types.size()) {
+		Preprocess preprocess;
+		unique_ptr<PreprocessedTask> prepTask(preprocess.preprocessProblemGoal(parsedTask));
+		Task problemTask(prepTask.get(), domainTask);
+		domainStages->classify(&problemTask, objects);
+	}
+	else {
+		classifyWithFullAnalysis(parsedTask, objects);
+	}
+}
+
+// Classifies the objects of several problems using the given number of threads. The
+// JSON documents are written in the order of the list, each one followed by a new line,
+// as soon as all the previous ones are available. If a problem cannot be classified, the
+// error message is written instead of its document. Returns the error code of the first
+// problem that failed, or 0 if all of them have been classified
+int Classifier::classify(const vector<string>& problemFileNames, int numThreads, ostream& out)
+{
+	int numProblems = (int)problemFileNames.size();
+	vector<string> results(numProblems);
+	vector<int> errorCodes(numProblems, 0);
+	vector<bool> finished(numProblems, false);
+	int errorCode = 0;
+	mutex resultsLock;
+	condition_variable resultReady;
+	WorkStealingPool pool(numThreads);
+	pool.start(numProblems, [&](int i) {
+		ostringstream result;
+		int problemError = 0;
+		try {
+			classify((char*)problemFileNames[i].c_str(), result);
+		}
+		catch (ParseError& e) {
+			problemError = e.code;
+			result.str(e.what());
+		}
+		catch (exception& e) {
+			problemError = 1;
+			result.str("Unable to classify " + problemFileNames[i] + ": " + e.what());
+		}
+		lock_guard<mutex> guard(resultsLock);
+		results[i] = result.str();
+		errorCodes[i] = problemError;
+		finished[i] = true;
+		resultReady.notify_all();
+	});
+	for (int i = 0; i < numProblems; i++) {
+		unique_lock<mutex> guard(resultsLock);
+		resultReady.wait(guard, [&] { return (bool)finished[i]; });
+		if (errorCode == 0) errorCode = errorCodes[i];
+		string result;
+		result.swap(results[i]);
+		guard.unlock();
+		out << result << endl;
+	}
+	pool.wait();
+	return errorCode;
+}
+
+// Classifies the objects of a problem repeating the domain analysis. Used when the
+// preprocessed operators depend on the problem objects
+void Classifier::classifyWithFullAnalysis(ParsedTask* parsedTask, vector<ObjectClassification>& objects)
+{
+	Preprocess preprocess;
+	unique_ptr<PreprocessedTask> prepTask(preprocess.preprocessTask(parsedTask));
+	Task task(prepTask.get());
+	Stages stages(&task);
+	stages.classify(&task, objects);
+}
@@ -0,0 +1,40 @@
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+/********************************************************/
+/* Classifies the objects of several problems of the    */
+/* same domain, analysing the domain only once.         */
+/********************************************************/
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../parser/parsedTask.h"
+#include "../preprocess/preprocessedTask.h"
+#include "task.h"
+#include "stages.h"
+
+class Classifier {
+private:
+	ParsedTask* parsedDomain;
+	PreprocessedTask* prepDomain;
+	Task* domainTask;
+	Stages* domainStages;
+	bool sharedAnalysis;		// False if the domain analysis depends on the problem objects
+	std::string cacheDir;		// Directory for the domain analysis cache (empty if not used)
+	void analyseDomain();
+	void classifyParsedProblem(ParsedTask* parsedTask, std::vector<ObjectClassification>& objects);
+	void classifyWithFullAnalysis(ParsedTask* parsedTask, std::vector<ObjectClassification>& objects);
+
+public:
+	Classifier(char* domainFileName, const char* cacheDir);
+	~Classifier();
+	void classify(char* problemFileName, std::ostream& out);
+	void classify(char* problemFileName, std::vector<ObjectClassification>& objects);
+	void classify(const char* problemName, const char* buffer, size_t length, std::vector<ObjectClassification>& objects);
+	int classify(const std::vector<std::string>& problemFileNames, int numThreads, std::ostream& out);
+	void toJSON();
+	std::string getDomainName() { return parsedDomain->domainName; }
+};
+
+#endif // !#ifndef CLASSIFIER_H
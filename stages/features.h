@@ -17,6 +17,7 @@ enum FeatureType {
 };
 
 class Feature {
+	friend class StagesCache;
 private:
 	TaskPredicate* predicate;
 	std::vector<TaskType*> arguments;
@@ -59,6 +60,7 @@ public:
 };
 
 class FeaturesOfType {
+	friend class StagesCache;
 private:
 	TaskType* type;
 	std::vector<Feature> features;
@@ -85,6 +87,7 @@ public:
 	void addTransitionRule(std::vector<Feature*>& enabler, std::vector<Feature*>& left, std::vector<Feature*>& right);
 	inline TaskType* getType() { return type; }
 	inline int numFeatures() { return (int)features.size(); }
+	inline int numTransitionRules() { return (int)transitionRules.size(); }
 	inline Feature* getFeature(int index) { return &features[index]; }
 	Feature* getFeature(TaskPredicate* predicate, int argNumber);
 	void getOutAdjacents(Feature* f, std::vector<Feature*>& adj);
@@ -1,4 +1,5 @@
 #include "stages.h"
+#include "../utils/profiler.h"
 #include <iostream>
 
 /********************************************************/
@@ -13,6 +14,7 @@ using namespace std;
 // Computes the set of features for each type
 void Stages::calculateFeatures()
 {
+	ProfileScope profile("calculateFeatures");
 	for (TaskType& t : task->types) {
 		// cout << t.name << endl;
 		this->featuresOfType.emplace_back(&t);
@@ -28,11 +30,13 @@ void Stages::calculateFeatures()
 		}
 	}
 	//for (FeaturesOfType& tf : this->featuresOfType) cout << tf.toString() << endl;
+	profile.count("features", countItems(&FeaturesOfType::numFeatures));
 }
 
 // Computes the set of transition rules for each type
 void Stages::calculateTransitionRules()
 {
+	ProfileScope profile("calculateTransitionRules");
 	for (TaskOperator& o : task->operators) {
 		//cout << endl << o.toString() << endl;
 		for (int paramNumber = 0; paramNumber < o.parameters.size(); paramNumber++) {
@@ -40,6 +44,7 @@ void Stages::calculateTransitionRules()
 		}
 	}
 	// for (FeaturesOfType& tf : this->featuresOfType) cout << tf.toStringTransitionRules() << endl;
+	profile.count("transitionRules", countItems(&FeaturesOfType::numTransitionRules));
 }
 
 // Computes the set of transition rules from a fiven operator
@@ -96,6 +101,7 @@ void Stages::addFeatureToTransitionRule(TaskEffect* eff, FeaturesOfType& ft, int
 // Classifies each feature (static, attribute, permanent, multiple, reversible, transient)
 void Stages::classifyFeatures()
 {
+	ProfileScope profile("classifyFeatures");
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		//cout << "\nTYPE: " << ft.getType()->name << endl;
 		int numFeatures = ft.numFeatures();
@@ -141,6 +147,8 @@ void Stages::classifyFeatures()
 // Computes mutex features
 void Stages::computeMutex()
 {
+	ProfileScope profile("computeMutex");
+	long numChecks = 0;
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		ft.startCheckMutex();
 		//cout << "\nTYPE: " << ft.getType()->name << endl;
@@ -152,6 +160,7 @@ void Stages::computeMutex()
 					Feature* f2 = ft.getFeature(j);
 					if (f2->getType() == FT_REVERSIBLE || f2->getType() == FT_TRANSIENT) {
 						ft.checkMutex(i, j);
+						numChecks++;
 					}
 				}
 			}
@@ -161,11 +170,13 @@ void Stages::computeMutex()
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		cout << ft.toStringMutex() << endl;
 	}*/
+	profile.count("mutexChecks", numChecks);
 }
 
 // Computes the basic stages
 void Stages::computeBasicStages()
 {
+	ProfileScope profile("computeBasicStages");
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		//cout << "TYPE: " << ft.getType()->name << endl;
 		int numFeatures = ft.numFeatures();
@@ -176,6 +187,7 @@ void Stages::computeBasicStages()
 		}
 		addReversibleFeaturesToBasicStage(&ft, &stage);
 	}
+	profile.count("basicStages", countItems(&FeaturesOfType::getNumBasicStages));
 }
 
 // Add reversible features to basic stages
@@ -280,10 +292,12 @@ void Stages::addMultipleFeaturesToBasicStage(FeaturesOfType* ft, std::vector<Fea
 // Computes additional stages
 void Stages::computeAdditionalStages()
 {
+	ProfileScope profile("computeAdditionalStages");
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		std::vector<Feature*> stage;
 		addAdditionalStage(&ft, &stage, 0);
 	}
+	profile.count("additionalStages", countItems(&FeaturesOfType::getNumAdditionalStages));
 }
 
 // Adds an additional stage
@@ -312,6 +326,7 @@ void Stages::addAdditionalStage(FeaturesOfType* ft, std::vector<Feature*>* stage
 // Computes combined stages
 void Stages::computeCombinedStages()
 {
+	ProfileScope profile("computeCombinedStages");
 	for (FeaturesOfType& ft : this->featuresOfType) {
 		int numStages = ft.getNumBasicStages();
 		for (int i = 0; i < numStages; i++) {
@@ -345,6 +360,8 @@ void Stages::computeCombinedStages()
 			}
 		}
 	}
+	profile.count("combinedStages", countItems(&FeaturesOfType::getNumCombinedStages));
+	profile.count("instancedFeatures", featurePool.size());
 }
 
 // Adds a combined stage
@@ -392,47 +409,57 @@ int Stages::typeIndex(TaskType* t)
 	return -1;
 }
 
+// Sums a number of items (features, stages, etc.) of all types
+int Stages::countItems(int (FeaturesOfType::*counter)())
+{
+	int n = 0;
+	for (FeaturesOfType& ft : featuresOfType)
+		n += (ft.*counter)();
+	return n;
+}
+
 // Gets the combined stage of an object
-int Stages::getCombinedStage(TaskObject* obj, FeaturesOfType* ft)
+int Stages::getCombinedStage(Task* problem, TaskObject* obj, FeaturesOfType* ft)
 {
 	int numStages = ft->getNumCombinedStages();
 	for (int i = 0; i < numStages; i++) {
 		vector<Feature*>* stage = ft->getCombinedStage(i);
-		if (checkCombinedStage(obj, stage))
+		if (checkCombinedStage(problem, obj, stage))
 			return i + 1;
 	}
 	return 0;
 }
 
 // Gets the additional stage of an object
-int Stages::getAdditionalStage(TaskObject* obj, FeaturesOfType* ft)
+int Stages::getAdditionalStage(Task* problem, TaskObject* obj, FeaturesOfType* ft)
 {
 	int numStages = ft->getNumAdditionalStages();
 	for (int i = numStages - 1; i >= 0; i--) {
 		vector<Feature*>* stage = ft->getAdditionalStage(i);
-		if (checkAdditionalStage(obj, stage))
+		if (checkAdditionalStage(problem, obj, stage))
 			return i + 1;
 	}
 	return 0;
 }
 
 // Checks if an object is in a given combined stage
-bool Stages::checkCombinedStage(TaskObject* obj, std::vector<Feature*>* stage)
+bool Stages::checkCombinedStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage)
 {
-	unordered_map<char, string> mapping;
-	mapping['x'] = obj->name;
+	unordered_map<char, TaskObject*> mapping;
+	mapping['x'] = obj;
 	int featureNumber = 0;
-	return checkCombinedStage(featureNumber, stage, &mapping);
+	return checkCombinedStage(problem, featureNumber, stage, &mapping);
 }
 
 // Checks if an object is in a given additional stage
-bool Stages::checkAdditionalStage(TaskObject* obj, std::vector<Feature*>* stage)
+bool Stages::checkAdditionalStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage)
 {
 	for (Feature* f : *stage) {
 		bool match = false;
-		for (TaskLiteral& l : task->state) {
-			if (l.predicate->index == f->getPredicate()->index && 
-				l.arguments[f->getFirstArgument()] == obj) {
+		int predicate = f->getPredicate()->index, firstArgument = f->getFirstArgument();
+		unsigned int numFacts = problem->state.numFactsOf(predicate);
+		for (unsigned int i = 0; i < numFacts; i++) {
+			if (problem->state.getArguments(predicate, i)[firstArgument] == obj->index) {
 				match = true;
 				break;
 			}
@@ -443,73 +470,81 @@ bool Stages::checkAdditionalStage(TaskObject* obj, std::vector<Feature*>* stage)
 }
 
 // Checks if a given feature in a combined stage holds
-bool Stages::checkCombinedStage(int featureNumber, std::vector<Feature*>* stage, unordered_map<char, string>* mapping)
+bool Stages::checkCombinedStage(Task* problem, int featureNumber, std::vector<Feature*>* stage,
+	unordered_map<char, TaskObject*>* mapping)
 {
 	if (featureNumber >= (int)stage->size()) return true;
 	Feature* f = stage->at(featureNumber);
-	for (TaskLiteral& l : task->state) {
-		if (l.predicate->index == f->getPredicate()->index) {
-			bool matching = true;
-			vector<char> newLetters;
-			for (int argNumber = 0; argNumber < (int)l.arguments.size(); argNumber++) {
-				TaskObject* arg = l.arguments[argNumber];
-				if (f->getArgument(argNumber) != NULL) {
-					char letter = f->getLetter(argNumber);
-					unordered_map<char, string>::const_iterator got = mapping->find(letter);
-					if (got == mapping->end()) { // New letter: store the matching
-						(*mapping)[letter] = arg->name;
-						newLetters.push_back(letter);
-					}
-					else { // Check that arguments match
-						if (got->second != arg->name) {
-							matching = false;
-							for (char newLetter : newLetters) mapping->erase(newLetter);
-							break;
-						}
+	int predicate = f->getPredicate()->index;
+	int numArgs = (int)problem->state.getArity(predicate);
+	unsigned int numFacts = problem->state.numFactsOf(predicate);
+	for (unsigned int i = 0; i < numFacts; i++) {
+		const int* args = problem->state.getArguments(predicate, i);
+		bool matching = true;
+		vector<char> newLetters;
+		for (int argNumber = 0; argNumber < numArgs; argNumber++) {
+			TaskObject* arg = &problem->objects[args[argNumber]];
+			if (f->getArgument(argNumber) != NULL) {
+				char letter = f->getLetter(argNumber);
+				unordered_map<char, TaskObject*>::const_iterator got = mapping->find(letter);
+				if (got == mapping->end()) { // New letter: store the matching
+					(*mapping)[letter] = arg;
+					newLetters.push_back(letter);
+				}
+				else { // Check that arguments match
+					if (got->second != arg) {
+						matching = false;
+						for (char newLetter : newLetters) mapping->erase(newLetter);
+						break;
 					}
 				}
 			}
-			if (matching && checkCombinedStage(featureNumber + 1, stage, mapping))
-				return true;
 		}
+		if (matching && checkCombinedStage(problem, featureNumber + 1, stage, mapping))
+			return true;
 	}
 	return false;
 }
 
 // Gets the goal stages of a given object
-void Stages::getGoalStages(TaskObject* obj, FeaturesOfType* ft, vector<int>& goalStages)
+void Stages::getGoalStages(Task* problem, TaskObject* obj, FeaturesOfType* ft, vector<int>& goalStages)
 {
 	int numStages = ft->getNumCombinedStages();
 	for (int i = 0; i < numStages; i++) {
 		vector<Feature*>* stage = ft->getCombinedStage(i);
-		if (checkGoalStage(obj, stage)) {
+		if (checkGoalStage(problem, obj, stage)) {
 			goalStages.push_back(i + 1);
 		}
 	}
 }
 
 // Gets the additional goal stages of a given object
-void Stages::getAdditionalGoalStages(TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages)
+void Stages::getAdditionalGoalStages(Task* problem, TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages)
 {
 	int numStages = ft->getNumAdditionalStages();
 	for (int i = 0; i < numStages; i++) {
 		vector<Feature*>* stage = ft->getAdditionalStage(i);
 		bool match = true;
 		// All static features must be in the intial state
-		for (TaskLiteral& l : task->state) {
-			int objIndex = l.find(obj);
-			if (objIndex != -1) {
-				Feature* f = ft->getFeature(l.predicate, objIndex);
-				if (f != NULL && f->getType() == FT_STATIC) {
-					if (!ft->findFeatureInVector(f, stage)) {
-						match = false;
-						break;
+		for (unsigned int p = 0; match && p < problem->state.numPredicates(); p++) {
+			unsigned int numArgs = problem->state.getArity(p), numFacts = problem->state.numFactsOf(p);
+			for (unsigned int fact = 0; fact < numFacts; fact++) {
+				const int* args = problem->state.getArguments(p, fact);
+				int objIndex = 0;
+				while (objIndex < (int)numArgs && args[objIndex] != obj->index) objIndex++;
+				if (objIndex < (int)numArgs) {
+					Feature* f = ft->getFeature(problem->state.getPredicate(p), objIndex);
+					if (f != NULL && f->getType() == FT_STATIC) {
+						if (!ft->findFeatureInVector(f, stage)) {
+							match = false;
+							break;
+						}
 					}
 				}
 			}
 		}
 		if (match) { // All attributes must be in the goal
-			for (TaskLiteral& l : task->goal) {
+			for (TaskLiteral& l : problem->goal) {
 				int objIndex = l.find(obj);
 				if (objIndex != -1) {
 					Feature* f = ft->getFeature(l.predicate, objIndex);
@@ -528,27 +563,27 @@ void Stages::getAdditionalGoalStages(TaskObject* obj, FeaturesOfType* ft, std::v
 }
 
 // Checks if an object is in a given goal stage
-bool Stages::checkGoalStage(TaskObject* obj, std::vector<Feature*>* stage)
+bool Stages::checkGoalStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage)
 {
 	// All literals in the goal containing obj must match with features in the stage
-	unordered_map<char, string> mapping;
-	mapping['x'] = obj->name;
-	return instanceGoalStage(0, obj, stage, &mapping);
+	unordered_map<char, TaskObject*> mapping;
+	mapping['x'] = obj;
+	return instanceGoalStage(problem, 0, obj, stage, &mapping);
 }
 
 // Tries to instantiate the arguments of a feature in a goal stage
-bool Stages::instanceGoalStage(int featureNumber, TaskObject* obj, std::vector<Feature*>* stage,
-	std::unordered_map<char, std::string>* mapping)
+bool Stages::instanceGoalStage(Task* problem, int featureNumber, TaskObject* obj, std::vector<Feature*>* stage,
+	std::unordered_map<char, TaskObject*>* mapping)
 {
 	//cout << obj->name << endl;
 	if (featureNumber >= (int)stage->size()) { // Instantiation done
-		return validateGoalStage(stage, mapping);
+		return validateGoalStage(problem, stage, mapping);
 	}
 	int numMatchings = 0;
 	Feature* f = stage->at(featureNumber);
 	//cout << f->toString() << endl;
 	if (hasInstancedParameters(f, mapping)) {
-		for (TaskLiteral& l : task->goal) {
+		for (TaskLiteral& l : problem->goal) {
 			if (l.predicate->index == f->getPredicate()->index) {
 				bool matching = true;
 				vector<char> newLetters;
@@ -556,13 +591,13 @@ bool Stages::instanceGoalStage(int featureNumber, TaskObject* obj, std::vector<F
 					TaskObject* arg = l.arguments[argNumber];
 					if (f->getArgument(argNumber) != NULL) {
 						char letter = f->getLetter(argNumber);
-						unordered_map<char, string>::const_iterator got = mapping->find(letter);
+						unordered_map<char, TaskObject*>::const_iterator got = mapping->find(letter);
 						if (got == mapping->end()) { // New letter: store the matching
-							(*mapping)[letter] = arg->name;
+							(*mapping)[letter] = arg;
 							newLetters.push_back(letter);
 						}
 						else { // Check that arguments match
-							if (got->second != arg->name) {
+							if (got->second != arg) {
 								matching = false;
 								break;
 							}
@@ -572,7 +607,7 @@ bool Stages::instanceGoalStage(int featureNumber, TaskObject* obj, std::vector<F
 				if (matching) {
 					//cout << " * Match: " << l.toString() << endl;
 					numMatchings++;
-					if (instanceGoalStage(featureNumber + 1, obj, stage, mapping))
+					if (instanceGoalStage(problem, featureNumber + 1, obj, stage, mapping))
 						return true;
 				}
 				for (char newLetter : newLetters) mapping->erase(newLetter);
@@ -580,13 +615,13 @@ bool Stages::instanceGoalStage(int featureNumber, TaskObject* obj, std::vector<F
 		}
 	}
 	if (numMatchings == 0) {
-		return instanceGoalStage(featureNumber + 1, obj, stage, mapping);
+		return instanceGoalStage(problem, featureNumber + 1, obj, stage, mapping);
 	}
 	return false;
 }
 
 // Check if a feature has grounded parameters
-bool Stages::hasInstancedParameters(Feature* f, std::unordered_map<char, std::string>* mapping)
+bool Stages::hasInstancedParameters(Feature* f, std::unordered_map<char, TaskObject*>* mapping)
 {
 	for (int i = 0; i < f->numArguments(); i++)
 		if (f->getArgument(i) != NULL && mapping->find(f->getLetter(i)) != mapping->end())
@@ -595,14 +630,14 @@ bool Stages::hasInstancedParameters(Feature* f, std::unordered_map<char, std::st
 }
 
 // Check if a grounded goal stage holds
-bool Stages::validateGoalStage(std::vector<Feature*>* stage, std::unordered_map<char, std::string>* mapping)
+bool Stages::validateGoalStage(Task* problem, std::vector<Feature*>* stage, std::unordered_map<char, TaskObject*>* mapping)
 {
 	for (Feature* f : *stage) {
 		if (hasInstancedParameters(f, mapping)) {
-			TaskLiteral* match = findInGoal(f, mapping);
+			TaskLiteral* match = findInGoal(problem, f, mapping);
 			if (match == NULL) {
 				// Check if feature is not mutex with goals
-				if (mutexWithGoals(f, mapping))
+				if (mutexWithGoals(problem, f, mapping))
 					return false;
 			}
 		}
@@ -611,17 +646,17 @@ bool Stages::validateGoalStage(std::vector<Feature*>* stage, std::unordered_map<
 }
 
 // Searches for a feature in the goal
-TaskLiteral* Stages::findInGoal(Feature* f, std::unordered_map<char, std::string>* mapping)
+TaskLiteral* Stages::findInGoal(Task* problem, Feature* f, std::unordered_map<char, TaskObject*>* mapping)
 {
-	for (TaskLiteral& l : task->goal) {
+	for (TaskLiteral& l : problem->goal) {
 		if (l.predicate->index == f->getPredicate()->index) {
 			bool match = true;
 			for (int argNumber = 0; argNumber < (int)l.arguments.size(); argNumber++) {
 				if (f->getArgument(argNumber) != NULL) {
 					char letter = f->getLetter(argNumber);
-					unordered_map<char, string>::const_iterator got = mapping->find(letter);
+					unordered_map<char, TaskObject*>::const_iterator got = mapping->find(letter);
 					if (got != mapping->end()) { // Letter found -> must match literal argument
-						if (got->second != l.arguments[argNumber]->name) {
+						if (got->second != l.arguments[argNumber]) {
 							match = false;
 							break;
 						}
@@ -637,9 +672,9 @@ TaskLiteral* Stages::findInGoal(Feature* f, std::unordered_map<char, std::string
 }
 
 // Check if a feature is mutex with the goals
-bool Stages::mutexWithGoals(Feature* f, std::unordered_map<char, std::string>* mapping)
+bool Stages::mutexWithGoals(Task* problem, Feature* f, std::unordered_map<char, TaskObject*>* mapping)
 {
-	for (TaskLiteral& l : task->goal) {
+	for (TaskLiteral& l : problem->goal) {
 		if (mutexWithGoal(f, &l, mapping))
 			return true;
 	}
@@ -647,16 +682,16 @@ bool Stages::mutexWithGoals(Feature* f, std::unordered_map<char, std::string>* m
 }
 
 // Checks if a feature is mutex with a goal literal
-bool Stages::mutexWithGoal(Feature* f, TaskLiteral* l, std::unordered_map<char, std::string>* mapping)
+bool Stages::mutexWithGoal(Feature* f, TaskLiteral* l, std::unordered_map<char, TaskObject*>* mapping)
 {
 	for (int argNumber = 0; argNumber < f->numArguments(); argNumber++) {
 		if (f->getArgument(argNumber) != NULL) {
 			char letter = f->getLetter(argNumber);
-			unordered_map<char, string>::const_iterator got = mapping->find(letter);
+			unordered_map<char, TaskObject*>::const_iterator got = mapping->find(letter);
 			if (got != mapping->end()) {
-				string objName = got->second;
+				TaskObject* obj = got->second;
 				for (int literalParam = 0; literalParam < (int)l->arguments.size(); literalParam++) {
-					if (l->arguments[literalParam]->name == objName) { // Check mutex
+					if (l->arguments[literalParam] == obj) { // Check mutex
 						TaskType* litParamType = l->predicate->arguments[literalParam];
 						FeaturesOfType* ft = getFeatureOfType(litParamType);
 						vector<Feature*>* mutex = ft->getMutex(l->predicate, literalParam);
@@ -684,18 +719,11 @@ FeaturesOfType* Stages::getFeatureOfType(TaskType* t)
 }
 
 // Checks if the goal is achieved for a given object
-int Stages::goalAchieved(TaskObject* obj)
-{
-	for (TaskLiteral& goal : task->goal) {
-		if (goal.contains(obj)) {
-			bool found = false;
-			for (TaskLiteral& l : task->state) {
-				if (l.equals(&goal)) {
-					found = true;
-					break;
-				}
-			}
-			if (!found) return 0;
+int Stages::goalAchieved(Task* problem, TaskObject* obj)
+{
+	for (TaskLiteral& goal : problem->goal) {
+		if (goal.contains(obj) && !problem->state.contains(&goal)) {
+			return 0;
 		}
 	}
 	return 1;
@@ -704,6 +732,7 @@ int Stages::goalAchieved(TaskObject* obj)
 // Analyses the task data
 Stages::Stages(Task* task)
 {
+	ProfileScope profile("stages");
 	this->task = task;
 	calculateFeatures();
 	calculateTransitionRules();
@@ -717,42 +746,74 @@ Stages::Stages(Task* task)
 // Classifies the objects in the problem
 void Stages::classify()
 {
-	cout << "{" << endl;
-	for (int i = 0; i < (int)task->objects.size(); i++) {
-		TaskObject* obj = &task->objects[i];
+	classify(task, cout);
+}
+
+// Classifies the objects of a problem that shares the domain of the analysed task,
+// writing the result in the given stream
+void Stages::classify(Task* problem, ostream& out)
+{
+	vector<ObjectClassification> objects;
+	classify(problem, objects);
+	toJSON(objects, out);
+}
+
+// Classifies the objects of a problem that shares the domain of the analysed task
+void Stages::classify(Task* problem, std::vector<ObjectClassification>& objects)
+{
+	ProfileScope profile("classify");
+	objects.resize(problem->objects.size());
+	for (int i = 0; i < (int)problem->objects.size(); i++) {
+		TaskObject* obj = &problem->objects[i];
+		ObjectClassification& oc = objects[i];
+		oc.name = obj->name;
+		oc.classified = false;
 		for (FeaturesOfType& ft : featuresOfType) {
 			if (ft.getType() == obj->type) {
-				cout << "  \"" << obj->name << "\": {" << endl;
-				cout << "    \"type\": \"" << ft.getType()->name << "\"," << endl;
-				int stage = getCombinedStage(obj, &ft);
-				cout << "    \"stage\": \"CS" << stage << "\"," << endl;
-				int addStage = getAdditionalStage(obj, &ft);
-				cout << "    \"addStage\": \"AS" << addStage << "\"," << endl;
-				vector<int> goalStages;
-				getGoalStages(obj, &ft, goalStages);
-				cout << "    \"goalStages\": [";
-				for (int i = 0; i < (int)goalStages.size(); i++) {
-					cout << "\"CS" << goalStages[i] << "\"";
-					if (i < (int)goalStages.size() - 1) cout << ", ";
-				}
-				cout << "]," << endl;
-				vector<int> addGoalStages;
-				getAdditionalGoalStages(obj, &ft, addGoalStages);
-				cout << "    \"addGoalStages\": [";
-				for (int i = 0; i < (int)addGoalStages.size(); i++) {
-					cout << "\"AS" << addGoalStages[i] << "\"";
-					if (i < (int)addGoalStages.size() - 1) cout << ", ";
-				}
-				cout << "]," << endl;
-				cout << "    \"goalAchieved\": " << goalAchieved(obj) << endl;
-				cout << "  }";
+				oc.classified = true;
+				oc.type = ft.getType()->name;
+				oc.stage = getCombinedStage(problem, obj, &ft);
+				oc.addStage = getAdditionalStage(problem, obj, &ft);
+				getGoalStages(problem, obj, &ft, oc.goalStages);
+				getAdditionalGoalStages(problem, obj, &ft, oc.addGoalStages);
+				oc.goalAchieved = goalAchieved(problem, obj);
 				break;
 			}
 		}
-		if (i < (int)task->objects.size() - 1) cout << ",";
-		cout << endl;
 	}
-	cout << "}";
+	profile.count("objects", objects.size());
+}
+
+// Writes the classification of the objects in JSON format
+void Stages::toJSON(std::vector<ObjectClassification>& objects, ostream& out)
+{
+	out << "{" << endl;
+	for (int i = 0; i < (int)objects.size(); i++) {
+		ObjectClassification& oc = objects[i];
+		if (oc.classified) {
+			out << "  \"" << oc.name << "\": {" << endl;
+			out << "    \"type\": \"" << oc.type << "\"," << endl;
+			out << "    \"stage\": \"CS" << oc.stage << "\"," << endl;
+			out << "    \"addStage\": \"AS" << oc.addStage << "\"," << endl;
+			out << "    \"goalStages\": [";
+			for (int i = 0; i < (int)oc.goalStages.size(); i++) {
+				out << "\"CS" << oc.goalStages[i] << "\"";
+				if (i < (int)oc.goalStages.size() - 1) out << ", ";
+			}
+			out << "]," << endl;
+			out << "    \"addGoalStages\": [";
+			for (int i = 0; i < (int)oc.addGoalStages.size(); i++) {
+				out << "\"AS" << oc.addGoalStages[i] << "\"";
+				if (i < (int)oc.addGoalStages.size() - 1) out << ", ";
+			}
+			out << "]," << endl;
+			out << "    \"goalAchieved\": " << oc.goalAchieved << endl;
+			out << "  }";
+		}
+		if (i < (int)objects.size() - 1) out << ",";
+		out << endl;
+	}
+	out << "}";
 }
 
 // Prints the type features
@@ -8,15 +8,33 @@
 /* Functions for calculating features and stages.	    */
 /********************************************************/
 
+#include <ostream>
 #include "task.h"
 #include "features.h"
 
+// Classification of a problem object. Objects whose type has no features are not
+// classified (classified = false)
+class ObjectClassification {
+public:
+	std::string name;
+	std::string type;
+	bool classified;
+	int stage;
+	int addStage;
+	std::vector<int> goalStages;
+	std::vector<int> addGoalStages;
+	int goalAchieved;
+};
+
 class Stages {
+	friend class StagesCache;
 private:
 	Task* task;
 	std::vector<FeaturesOfType> featuresOfType;
 	std::vector<Feature*> featurePool;
 
+	Stages() { }			// Used to load the stages from a cache file
+
 	void calculateFeatures();
 	void calculateTransitionRules();
 	void calculateOperatorTransitionRule(TaskOperator* o, int paramNumber);
@@ -37,27 +55,32 @@ private:
 	void addCombinedStages(FeaturesOfType* ft, std::vector<Feature*>* stage, char letter,
 		std::vector< std::vector<Feature*> >* setOfCombinedStages);
 	int typeIndex(TaskType* t);
-	int getCombinedStage(TaskObject* obj, FeaturesOfType* ft);
-	int getAdditionalStage(TaskObject* obj, FeaturesOfType* ft);
-	bool checkCombinedStage(TaskObject* obj, std::vector<Feature*>* stage);
-	bool checkAdditionalStage(TaskObject* obj, std::vector<Feature*>* stage);
-	bool checkCombinedStage(int featureNumber, std::vector<Feature*>* stage, std::unordered_map<char, std::string>* mapping);
-	void getGoalStages(TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages);
-	void getAdditionalGoalStages(TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages);
-	bool checkGoalStage(TaskObject* obj, std::vector<Feature*>* stage);
-	bool instanceGoalStage(int featureNumber, TaskObject* obj, std::vector<Feature*>* stage, 
-		std::unordered_map<char, std::string>* mapping);
-	bool hasInstancedParameters(Feature* f, std::unordered_map<char, std::string>* mapping);
-	bool validateGoalStage(std::vector<Feature*>* stage, std::unordered_map<char, std::string>* mapping);
-	TaskLiteral* findInGoal(Feature* f, std::unordered_map<char, std::string>* mapping);
-	bool mutexWithGoals(Feature* f, std::unordered_map<char, std::string>* mapping);
-	bool mutexWithGoal(Feature* f, TaskLiteral* l, std::unordered_map<char, std::string>* mapping);
+	int countItems(int (FeaturesOfType::*counter)());
+	int getCombinedStage(Task* problem, TaskObject* obj, FeaturesOfType* ft);
+	int getAdditionalStage(Task* problem, TaskObject* obj, FeaturesOfType* ft);
+	bool checkCombinedStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage);
+	bool checkAdditionalStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage);
+	bool checkCombinedStage(Task* problem, int featureNumber, std::vector<Feature*>* stage,
+		std::unordered_map<char, TaskObject*>* mapping);
+	void getGoalStages(Task* problem, TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages);
+	void getAdditionalGoalStages(Task* problem, TaskObject* obj, FeaturesOfType* ft, std::vector<int>& goalStages);
+	bool checkGoalStage(Task* problem, TaskObject* obj, std::vector<Feature*>* stage);
+	bool instanceGoalStage(Task* problem, int featureNumber, TaskObject* obj, std::vector<Feature*>* stage, 
+		std::unordered_map<char, TaskObject*>* mapping);
+	bool hasInstancedParameters(Feature* f, std::unordered_map<char, TaskObject*>* mapping);
+	bool validateGoalStage(Task* problem, std::vector<Feature*>* stage, std::unordered_map<char, TaskObject*>* mapping);
+	TaskLiteral* findInGoal(Task* problem, Feature* f, std::unordered_map<char, TaskObject*>* mapping);
+	bool mutexWithGoals(Task* problem, Feature* f, std::unordered_map<char, TaskObject*>* mapping);
+	bool mutexWithGoal(Feature* f, TaskLiteral* l, std::unordered_map<char, TaskObject*>* mapping);
 	FeaturesOfType* getFeatureOfType(TaskType* t);
-	int goalAchieved(TaskObject* obj);
+	int goalAchieved(Task* problem, TaskObject* obj);
 
 public:
 	Stages(Task* task);
 	void classify();
+	void classify(Task* problem, std::ostream& out);
+	void classify(Task* problem, std::vector<ObjectClassification>& objects);
+	static void toJSON(std::vector<ObjectClassification>& objects, std::ostream& out);
 	void toJSON();
 };
 
@@ -0,0 +1,339 @@
+/********************************************************/
+/* Binary cache of the domain analysis (features,       */
+/* transition rules, mutex and stages). The cache file  */
+/* is named after a hash of the parsed domain and       */
+/* includes a checksum to detect corrupted or stale     */
+/* files.                                               */
+/********************************************************/
+
+#include "stagesCache.h"
+#include "../preprocess/preprocess.h"
+#include "../utils/profiler.h"
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+// File header
+const char CACHE_MAGIC[4] = { 'P', 'F', 'E', 'C' };
+const uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t domainHash;
+	uint64_t payloadLength;
+	uint64_t checksum;
+};
+
+// Creates a cache for the given domain. The parsed domain is only used to compute its hash
+StagesCache::StagesCache(const char* cacheDir, ParsedTask* parsedDomain)
+{
+	string normalizedDomain = parsedDomain->toString();
+	if (Preprocess::getMaxOperatorsPerAction() > 0)		// The limit changes the operators
+		normalizedDomain += "\nmax-operators " + to_string(Preprocess::getMaxOperatorsPerAction());
+	domainHash = hash(normalizedDomain.c_str(), normalizedDomain.length());
+	char hexHash[17];
+	snprintf(hexHash, sizeof(hexHash), "%016llx", (unsigned long long)domainHash);
+	fileName = string(cacheDir) + "/" + parsedDomain->domainName + "-" + hexHash + ".stc";
+	task = nullptr;
+	buffer = nullptr;
+	bufferLength = 0;
+	position = 0;
+}
+
+// FNV-1a hash
+uint64_t StagesCache::hash(const char* data, size_t length)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		h ^= (unsigned char)data[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/********************************************************/
+/* Writing                                              */
+/********************************************************/
+
+// Saves the domain analysis in the cache file. Errors are ignored, as the cache is optional
+void StagesCache::save(Stages* stages)
+{
+	task = stages->task;
+	data.clear();
+	featureId.clear();
+	int32_t id = 0;
+	for (FeaturesOfType& ft : stages->featuresOfType)
+		for (Feature& f : ft.features)
+			featureId[&f] = id++;
+	for (Feature* f : stages->featurePool)
+		featureId[f] = id++;
+	writeInt((int32_t)task->types.size());
+	writeInt((int32_t)task->predicates.size());
+	writeInt((int32_t)stages->featuresOfType.size());
+	for (FeaturesOfType& ft : stages->featuresOfType) {
+		writeInt(typeIndex(ft.type));
+		writeInt((int32_t)ft.features.size());
+		for (Feature& f : ft.features)
+			writeFeature(&f);
+	}
+	writeInt((int32_t)stages->featurePool.size());
+	for (Feature* f : stages->featurePool)
+		writeFeature(f);
+	for (FeaturesOfType& ft : stages->featuresOfType) {
+		writeInt((int32_t)ft.transitionRules.size());
+		for (TransitionRule& tr : ft.transitionRules) {
+			writeFeatureVector(tr.enabler);
+			writeFeatureVector(tr.left);
+			writeFeatureVector(tr.right);
+		}
+		writeFeatureVectors(ft.mutex);
+		writeFeatureVectors(ft.basicStages);
+		writeFeatureVectors(ft.additionalStages);
+		writeFeatureVectors(ft.combinedStages);
+	}
+	CacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.domainHash = domainHash;
+	header.payloadLength = data.length();
+	header.checksum = hash(data.c_str(), data.length());
+	// Written to a temporary file first, so other processes never see an incomplete cache
+	string tmpFileName = fileName + "." + to_string(getpid()) + ".tmp";
+	ofstream out(tmpFileName, ios::binary);
+	if (!out.is_open()) return;
+	out.write((const char*)&header, sizeof(header));
+	out.write(data.c_str(), data.length());
+	out.close();
+	if (out.fail() || rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+		remove(tmpFileName.c_str());
+	data.clear();
+}
+
+// Writes an integer
+void StagesCache::writeInt(int32_t value)
+{
+	data.append((const char*)&value, sizeof(value));
+}
+
+// Writes the data of a feature
+void StagesCache::writeFeature(Feature* f)
+{
+	writeInt(predicateIndex(f->predicate));
+	writeInt(f->firstArgument);
+	writeInt(f->type);
+	writeInt(f->combined ? 1 : 0);
+	writeInt((int32_t)f->arguments.size());
+	for (int i = 0; i < (int)f->arguments.size(); i++) {
+		writeInt(typeIndex(f->arguments[i]));
+		writeInt(f->letter[i]);
+	}
+}
+
+// Writes a vector of features as a list of feature identifiers
+void StagesCache::writeFeatureVector(std::vector<Feature*>& v)
+{
+	writeInt((int32_t)v.size());
+	for (Feature* f : v)
+		writeInt(featureId[f]);
+}
+
+// Writes a vector of feature vectors
+void StagesCache::writeFeatureVectors(std::vector< std::vector<Feature*> >& v)
+{
+	writeInt((int32_t)v.size());
+	for (std::vector<Feature*>& fv : v)
+		writeFeatureVector(fv);
+}
+
+// Returns the position of a type in the task (-1 if null)
+int32_t StagesCache::typeIndex(TaskType* t)
+{
+	return t == nullptr ? -1 : (int32_t)(t - &task->types[0]);
+}
+
+// Returns the position of a predicate in the task
+int32_t StagesCache::predicateIndex(TaskPredicate* p)
+{
+	return (int32_t)(p - &task->predicates[0]);
+}
+
+/********************************************************/
+/* Reading                                              */
+/********************************************************/
+
+// Loads the domain analysis from the cache file. Returns nullptr if the file does not exist,
+// is corrupted or does not match the domain
+Stages* StagesCache::load(Task* task)
+{
+	ProfileScope profile("loadStagesCache");
+	this->task = task;
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return nullptr;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+		close(fd);
+		return nullptr;
+	}
+	size_t fileLength = (size_t)st.st_size;
+	void* map = mmap(nullptr, fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return nullptr;
+	Stages* stages = nullptr;
+	CacheHeader header;
+	memcpy(&header, map, sizeof(header));
+	buffer = (const char*)map + sizeof(header);
+	bufferLength = fileLength - sizeof(header);
+	position = 0;
+	if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == CACHE_VERSION &&
+		header.domainHash == domainHash && header.payloadLength == bufferLength &&
+		header.checksum == hash(buffer, bufferLength)) {
+		stages = new Stages();
+		stages->task = task;
+		if (!readStages(stages)) {
+			for (Feature* f : stages->featurePool)
+				delete f;
+			delete stages;
+			stages = nullptr;
+		}
+	}
+	munmap(map, fileLength);
+	buffer = nullptr;
+	features.clear();
+	return stages;
+}
+
+// Reads the analysis data. Returns false if it does not match the task
+bool StagesCache::readStages(Stages* stages)
+{
+	int32_t numTypes, numPredicates, numFeaturesOfType, numPoolFeatures;
+	if (!readInt(numTypes) || numTypes != (int32_t)task->types.size() ||
+		!readInt(numPredicates) || numPredicates != (int32_t)task->predicates.size() ||
+		!readCount(numFeaturesOfType))
+		return false;
+	stages->featuresOfType.reserve(numFeaturesOfType);
+	for (int32_t i = 0; i < numFeaturesOfType; i++) {
+		TaskType* t;
+		int32_t numFeatures;
+		if (!readType(t, false) || !readCount(numFeatures))
+			return false;
+		stages->featuresOfType.emplace_back(t);
+		std::vector<Feature>& ftFeatures = stages->featuresOfType.back().features;
+		ftFeatures.reserve(numFeatures);
+		for (int32_t j = 0; j < numFeatures; j++)
+			if (!readFeature(ftFeatures))
+				return false;
+	}
+	features.clear();
+	for (FeaturesOfType& ft : stages->featuresOfType)
+		for (Feature& f : ft.features)
+			features.push_back(&f);
+	if (!readCount(numPoolFeatures))
+		return false;
+	std::vector<Feature> pool;
+	pool.reserve(numPoolFeatures);
+	for (int32_t i = 0; i < numPoolFeatures; i++) {
+		if (!readFeature(pool))
+			return false;
+		Feature* f = new Feature(pool.back());
+		stages->featurePool.push_back(f);
+		features.push_back(f);
+	}
+	for (FeaturesOfType& ft : stages->featuresOfType) {
+		int32_t numRules;
+		if (!readCount(numRules))
+			return false;
+		for (int32_t i = 0; i < numRules; i++) {
+			std::vector<Feature*> enabler, left, right;
+			if (!readFeatureVector(enabler) || !readFeatureVector(left) || !readFeatureVector(right))
+				return false;
+			ft.transitionRules.emplace_back(&enabler, &left, &right);
+		}
+		if (!readFeatureVectors(ft.mutex) || !readFeatureVectors(ft.basicStages) ||
+			!readFeatureVectors(ft.additionalStages) || !readFeatureVectors(ft.combinedStages))
+			return false;
+	}
+	return position == bufferLength;
+}
+
+// Reads an integer
+bool StagesCache::readInt(int32_t& value)
+{
+	if (position + sizeof(value) > bufferLength) return false;
+	memcpy(&value, buffer + position, sizeof(value));
+	position += sizeof(value);
+	return true;
+}
+
+// Reads the number of elements of a list
+bool StagesCache::readCount(int32_t& value)
+{
+	return readInt(value) && value >= 0 && (size_t)value <= bufferLength;
+}
+
+// Reads a type index and returns the corresponding type
+bool StagesCache::readType(TaskType*& t, bool allowNull)
+{
+	int32_t index;
+	if (!readInt(index)) return false;
+	if (index == -1 && allowNull) t = nullptr;
+	else if (index >= 0 && index < (int32_t)task->types.size()) t = &task->types[index];
+	else return false;
+	return true;
+}
+
+// Reads a feature and adds it to the given vector
+bool StagesCache::readFeature(std::vector<Feature>& v)
+{
+	int32_t predIndex, firstArgument, type, combined, numArguments;
+	if (!readInt(predIndex) || predIndex < 0 || predIndex >= (int32_t)task->predicates.size() ||
+		!readInt(firstArgument) || !readInt(type) || type < FT_UNUSED || type > FT_REVERSIBLE ||
+		!readInt(combined) || !readInt(numArguments))
+		return false;
+	TaskPredicate* pred = &task->predicates[predIndex];
+	if (numArguments != (int32_t)pred->arguments.size() || firstArgument < 0 || firstArgument >= numArguments)
+		return false;
+	v.emplace_back(pred, firstArgument, nullptr);
+	Feature& f = v.back();
+	f.type = (FeatureType)type;
+	f.combined = combined != 0;
+	for (int32_t i = 0; i < numArguments; i++) {
+		int32_t letter;
+		if (!readType(f.arguments[i], true) || !readInt(letter))
+			return false;
+		f.letter[i] = (char)letter;
+	}
+	return true;
+}
+
+// Reads a vector of feature identifiers and returns the corresponding features
+bool StagesCache::readFeatureVector(std::vector<Feature*>& v)
+{
+	int32_t size;
+	if (!readCount(size)) return false;
+	v.reserve(size);
+	for (int32_t i = 0; i < size; i++) {
+		int32_t id;
+		if (!readInt(id) || id < 0 || id >= (int32_t)features.size())
+			return false;
+		v.push_back(features[id]);
+	}
+	return true;
+}
+
+// Reads a vector of feature vectors
+bool StagesCache::readFeatureVectors(std::vector< std::vector<Feature*> >& v)
+{
+	int32_t size;
+	if (!readCount(size)) return false;
+	v.resize(size);
+	for (int32_t i = 0; i < size; i++)
+		if (!readFeatureVector(v[i]))
+			return false;
+	return true;
+}
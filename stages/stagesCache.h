@@ -0,0 +1,52 @@
+#ifndef STAGES_CACHE_H
+#define STAGES_CACHE_H
+
+/********************************************************/
+/* Binary cache of the domain analysis (features,       */
+/* transition rules, mutex and stages). The cache file  */
+/* is named after a hash of the parsed domain and       */
+/* includes a checksum to detect corrupted or stale     */
+/* files.                                               */
+/********************************************************/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "../parser/parsedTask.h"
+#include "stages.h"
+
+class StagesCache {
+private:
+	std::string fileName;
+	uint64_t domainHash;
+	Task* task;
+	std::string data;								// Used for writing
+	const char* buffer;								// Used for reading
+	size_t bufferLength;
+	size_t position;
+	std::unordered_map<Feature*, int32_t> featureId;
+	std::vector<Feature*> features;
+
+	static uint64_t hash(const char* data, size_t length);
+	void writeInt(int32_t value);
+	void writeFeature(Feature* f);
+	void writeFeatureVector(std::vector<Feature*>& v);
+	void writeFeatureVectors(std::vector< std::vector<Feature*> >& v);
+	int32_t typeIndex(TaskType* t);
+	int32_t predicateIndex(TaskPredicate* p);
+	bool readInt(int32_t& value);
+	bool readCount(int32_t& value);
+	bool readType(TaskType*& t, bool allowNull);
+	bool readFeature(std::vector<Feature>& v);
+	bool readFeatureVector(std::vector<Feature*>& v);
+	bool readFeatureVectors(std::vector< std::vector<Feature*> >& v);
+	bool readStages(Stages* stages);
+
+public:
+	StagesCache(const char* cacheDir, ParsedTask* parsedDomain);
+	Stages* load(Task* task);
+	void save(Stages* stages);
+};
+
+#endif // !#ifndef STAGES_CACHE_H
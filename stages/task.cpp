@@ -1,4 +1,5 @@
 #include "task.h"
+#include "../utils/profiler.h"
 #include <iostream>
 
 /********************************************************/
@@ -15,6 +16,18 @@ using namespace std;
 /* CLASS: Task (processed planning task)                */
 /********************************************************/
 
+// Adds a value to the key of a predicate (FNV-1a step)
+static inline uint64_t addToPredicateKey(uint64_t key, unsigned int value)
+{
+	return (key ^ value) * 1099511628211ULL;
+}
+
+// Initial key of the predicates generated from a parsed function
+static inline uint64_t predicateKey(unsigned int function)
+{
+	return addToPredicateKey(14695981039346656037ULL, function);
+}
+
 // Gets the object types from the domain
 void Task::processTypes()
 {
@@ -60,6 +73,7 @@ void Task::processPredicates()
 			generatePredicate(&f, &args);
 		}
 	}
+	indexPredicates();
 	/*
 	for (TaskPredicate& p : this->predicates) {
 		cout << p.toString() << endl;
@@ -96,6 +110,44 @@ void Task::generatePredicate(Function* f, vector<TaskType*>* args)
 	}
 }
 
+// Indexes the predicates by their parsed function and the types of their arguments. If
+// several predicates have the same types, only the first one is indexed, as it is the one
+// the lookups have always returned
+void Task::indexPredicates()
+{
+	predicatesByKey.reserve(predicates.size());
+	for (TaskPredicate& pred : predicates) {
+		unsigned int numArgs = (unsigned int)pred.arguments.size();
+		auto argType = [&pred](unsigned int arg) { return pred.arguments[arg]->index; };
+		if (getPredicate(oldPredicateIndex[pred.index], numArgs, argType) == NULL) {
+			uint64_t key = predicateKey(oldPredicateIndex[pred.index]);
+			for (unsigned int arg = 0; arg < numArgs; arg++)
+				key = addToPredicateKey(key, argType(arg));
+			predicatesByKey.emplace(key, pred.index);
+		}
+	}
+}
+
+// Returns the predicate generated from the given parsed function whose arguments have the
+// task types given by argType(0) ... argType(numArgs - 1), or NULL if there is none
+template<typename ArgType>
+TaskPredicate* Task::getPredicate(unsigned int function, unsigned int numArgs, ArgType argType)
+{
+	uint64_t key = predicateKey(function);
+	for (unsigned int arg = 0; arg < numArgs; arg++)
+		key = addToPredicateKey(key, argType(arg));
+	auto range = domain->predicatesByKey.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it) {		// Discards hash collisions
+		TaskPredicate& pred = domain->predicates[it->second];
+		if (domain->oldPredicateIndex[pred.index] != (int)function || pred.arguments.size() != numArgs) continue;
+		bool match = true;
+		for (unsigned int arg = 0; arg < numArgs && match; arg++)
+			match = pred.arguments[arg]->index == argType(arg);
+		if (match) return &pred;
+	}
+	return NULL;
+}
+
 // Gets the operators defined in the domain 
 void Task::processOperators()
 {
@@ -177,52 +229,46 @@ void Task::generateEffect(TaskOperator* to, OpFluent* eff, Operator* o, bool isP
 	}
 }
 
-// Checks if an operator effect matches the given literal
+// Checks if an operator effect matches the given literal. An argument can have several
+// types (either), so every combination of argument types is looked up and the predicate
+// with the lowest index is returned
 TaskPredicate* Task::matchEffect(Literal* l, std::vector<TaskType*>* opParams, Operator* o, std::vector<int>& parameterIndex)
 {
-	for (TaskPredicate& pred : this->predicates) {
-		if (this->oldPredicateIndex[pred.index] == l->fncIndex) {
-			bool matchParams = true;
-			vector<unsigned int>* argTypes;
-			int paramNumber = 0;
-			parameterIndex.clear();
-			for (Term& term : l->params) {
-				switch (term.type) {
-				case TERM_CONSTANT:
-					argTypes = &task->task->objects[term.index].types;
-					parameterIndex.push_back(-1);
-					break;
-				case TERM_PARAMETER:
-					argTypes = &o->parameters[term.index].types;
-					parameterIndex.push_back(term.index);
-					break;
-				default:
-					argTypes = NULL;
-				}
-				if (argTypes == NULL) {
-					matchParams = false;
-					break;
-				}
-				else {
-					bool matchArg = false;
-					for (unsigned int argType : *argTypes) {
-						int taskTypeIndex = this->newTypeIndex[argType];
-						if (taskTypeIndex != -1 && pred.arguments[paramNumber]->index == taskTypeIndex) {
-							matchArg = true;
-							break;
-						}
-					}
-					if (!matchArg) {
-						matchParams = false;
-						break;
-					}
-					paramNumber++;
-				}
-			}
-			if (matchParams) return &pred;
+	vector< vector<int> > argTypes;		// Task types of each argument
+	parameterIndex.clear();
+	for (Term& term : l->params) {
+		vector<unsigned int>* types;
+		switch (term.type) {
+		case TERM_CONSTANT:
+			types = &task->task->objects[term.index].types;
+			parameterIndex.push_back(-1);
+			break;
+		case TERM_PARAMETER:
+			types = &o->parameters[term.index].types;
+			parameterIndex.push_back(term.index);
+			break;
+		default:
+			return NULL;
+		}
+		argTypes.emplace_back();
+		for (unsigned int type : *types) {
+			int taskTypeIndex = this->newTypeIndex[type];
+			if (taskTypeIndex != -1) argTypes.back().push_back(taskTypeIndex);
 		}
+		if (argTypes.back().empty()) return NULL;
 	}
-	return NULL;
+	unsigned int numArgs = (unsigned int)argTypes.size();
+	vector<unsigned int> choice(numArgs, 0);
+	TaskPredicate* found = NULL;
+	while (true) {
+		TaskPredicate* pred = getPredicate(l->fncIndex, numArgs,
+			[&](unsigned int arg) { return argTypes[arg][choice[arg]]; });
+		if (pred != NULL && (found == NULL || pred->index < found->index)) found = pred;
+		unsigned int arg = 0;		// Next combination of argument types
+		while (arg < numArgs && ++choice[arg] == argTypes[arg].size()) choice[arg++] = 0;
+		if (arg == numArgs) break;
+	}
+	return found;
 }
 
 // Gets the objects from the problem
@@ -230,11 +276,12 @@ void Task::processObjects()
 {
 	for (Object& o : task->task->objects) {
 		if (o.index != task->task->CONSTANT_TRUE && o.index != task->task->CONSTANT_FALSE && o.name.at(0) != '#') {
-			int typeIndex = newTypeIndex[o.types[0]];
+			int typeIndex = o.types[0] < domain->newTypeIndex.size() ? domain->newTypeIndex[o.types[0]] : -1;
 			if (typeIndex != -1) {
-				newObjectIndex.push_back((int)objects.size());
-				TaskType* t = &types[typeIndex];
-				objects.emplace_back(o.name, t);
+				int index = (int)objects.size();
+				newObjectIndex.push_back(index);
+				TaskType* t = &domain->types[typeIndex];
+				objects.emplace_back(index, o.name, t);
 			}
 			else newObjectIndex.push_back(-1);
 		}
@@ -242,28 +289,44 @@ void Task::processObjects()
 	}
 }
 
-// Gets the initial state from the problem
+// Gets the initial state from the problem: the plain atoms and then the rest of the
+// non-numeric facts. The predicate of every fact is found first, so that the facts can
+// be stored grouped by predicate
 void Task::processInitialState()
 {
+	AtomStore& atoms = task->task->initAtoms;
+	vector<int> factPredicates;		// Predicate of each fact (-1 if it does not match any)
+	factPredicates.reserve(atoms.size());
+	for (unsigned int i = 0; i < atoms.size(); i++) {
+		TaskPredicate* predicate = findPredicate(atoms.functions[i], atoms.getArguments(i), atoms.numArguments(i));
+		factPredicates.push_back(predicate != NULL ? predicate->index : -1);
+	}
 	for (Fact& f : task->task->init) {
 		if (!f.valueIsNumeric) {
-			TaskPredicate* predicate = findPredicate(&f);
-			if (predicate != NULL) {
-				vector<TaskObject*> params;
-				for (unsigned int obj : f.parameters) {
-					int newObj = newObjectIndex[obj];
-					if (newObj != -1) {
-						params.push_back(&objects[newObj]);
-					}
-					else {
-						predicate = NULL;
-						break;
-					}
-				}
-				if (predicate != NULL) state.emplace_back(predicate, params);
-			}
+			TaskPredicate* predicate = findPredicate(f.function, f.parameters.data(), (unsigned int)f.parameters.size());
+			factPredicates.push_back(predicate != NULL ? predicate->index : -1);
 		}
 	}
+	state.initialize(domain->predicates, factPredicates);
+	unsigned int fact = 0;
+	for (unsigned int i = 0; i < atoms.size(); i++) {
+		addInitialFact(factPredicates[fact++], atoms.getArguments(i));
+	}
+	for (Fact& f : task->task->init) {
+		if (!f.valueIsNumeric)
+			addInitialFact(factPredicates[fact++], f.parameters.data());
+	}
+}
+
+// Adds a fact to the initial state, if it matches a predicate
+void Task::addInitialFact(int predicate, const unsigned int* args)
+{
+	if (predicate != -1) {
+		int* params = state.addFact(predicate);
+		unsigned int numArgs = state.getArity(predicate);
+		for (unsigned int i = 0; i < numArgs; i++)
+			params[i] = newObjectIndex[args[i]];
+	}
 }
 
 // Gets the goals from the problem
@@ -295,63 +358,59 @@ void Task::processGoal()
 	}
 }
 
-// Searches the corresponding predicate of a given initial-state fact
-TaskPredicate* Task::findPredicate(Fact* f)
+// Searches the corresponding predicate of a given initial-state fact. Returns NULL if there
+// is no predicate for the types of the arguments, or if an argument is not a task object
+TaskPredicate* Task::findPredicate(unsigned int function, const unsigned int* args, unsigned int numArgs)
 {
-	//cout << f->toString(task->task->functions, task->task->objects);
-	for (TaskPredicate& pred : predicates) {
-		if (pred.name == task->task->functions[f->function].name && pred.arguments.size() == f->parameters.size()) {
-			bool match = true;
-			for (int arg = 0; arg < (int)pred.arguments.size(); arg++) {
-				TaskObject& obj = objects[newObjectIndex[f->parameters[arg]]];
-				if (pred.arguments[arg] != obj.type) {
-					match = false;
-					break;
-				}
-			}
-			if (match) {
-				//cout << " matches " << pred.toString() << endl;
-				return &pred;
-			}
-		}
-	}
-	//cout << endl;
-	return NULL;
+	for (unsigned int arg = 0; arg < numArgs; arg++)
+		if (newObjectIndex[args[arg]] == -1) return NULL;
+	return getPredicate(function, numArgs,
+		[&](unsigned int arg) { return objects[newObjectIndex[args[arg]]].type->index; });
 }
 
 // Searches for the predicate of a given literal
 TaskPredicate* Task::findPredicate(Literal* l)
 {
-	for (TaskPredicate& pred : predicates) {
-		if (pred.name == task->task->functions[l->fncIndex].name && pred.arguments.size() == l->params.size()) {
-			bool match = true;
-			for (int arg = 0; arg < (int)pred.arguments.size(); arg++) {
-				TaskObject& obj = objects[newObjectIndex[l->params[arg].index]];
-				if (pred.arguments[arg] != obj.type) {
-					match = false;
-					break;
-				}
-			}
-			if (match) {
-				//cout << " matches " << pred.toString() << endl;
-				return &pred;
-			}
-		}
-	}
-	//cout << endl;
-	return NULL;
+	unsigned int numArgs = (unsigned int)l->params.size();
+	for (unsigned int arg = 0; arg < numArgs; arg++)
+		if (newObjectIndex[l->params[arg].index] == -1) return NULL;
+	return getPredicate(l->fncIndex, numArgs,
+		[&](unsigned int arg) { return objects[newObjectIndex[l->params[arg].index]].type->index; });
 }
 
 // Creates the task
 Task::Task(PreprocessedTask* pTask)
 {
+	ProfileScope profile("task");
 	this->task = pTask;
+	this->domain = this;
 	processTypes();
 	processPredicates();
 	processOperators();
 	processObjects();
 	processInitialState();
 	processGoal();
+	profile.count("types", types.size());
+	profile.count("predicates", predicates.size());
+	profile.count("operators", operators.size());
+	profile.count("objects", objects.size());
+	profile.count("facts", state.size());
+	profile.count("goals", goal.size());
+}
+
+// Creates a task with only the problem data (objects, initial state and goals). Types
+// and predicates are taken from the given domain task, which must remain allocated
+Task::Task(PreprocessedTask* pTask, Task* domainTask)
+{
+	ProfileScope profile("problemTask");
+	this->task = pTask;
+	this->domain = domainTask;
+	processObjects();
+	processInitialState();
+	processGoal();
+	profile.count("objects", objects.size());
+	profile.count("facts", state.size());
+	profile.count("goals", goal.size());
 }
 
 /********************************************************/
@@ -530,3 +589,53 @@ bool TaskLiteral::equals(TaskLiteral* l)
 	}
 	return true;
 }
+
+/********************************************************/
+/* CLASS: TaskState (initial state by predicate)        */
+/********************************************************/
+
+// Reserves the space of the facts, given the predicate of each one (-1 for the facts
+// that will not be added)
+void TaskState::initialize(std::vector<TaskPredicate>& predicates, const std::vector<int>& factPredicates)
+{
+	unsigned int numPredicates = (unsigned int)predicates.size();
+	this->predicates.resize(numPredicates);
+	arity.resize(numPredicates);
+	for (unsigned int i = 0; i < numPredicates; i++) {
+		this->predicates[i] = &predicates[i];
+		arity[i] = (unsigned int)predicates[i].arguments.size();
+	}
+	vector<unsigned int> count(numPredicates, 0);
+	for (int p : factPredicates)
+		if (p != -1) count[p]++;
+	firstArgument.resize(numPredicates + 1);
+	firstArgument[0] = 0;
+	for (unsigned int i = 0; i < numPredicates; i++)
+		firstArgument[i + 1] = firstArgument[i] + count[i] * arity[i];
+	nextArgument.assign(firstArgument.begin(), firstArgument.end() - 1);
+	arguments.resize(firstArgument[numPredicates]);
+	numFacts = 0;
+}
+
+// Adds a fact of the given predicate. Returns the position where its arguments must be written
+int* TaskState::addFact(int predicate)
+{
+	int* params = arguments.data() + nextArgument[predicate];
+	nextArgument[predicate] += arity[predicate];
+	numFacts++;
+	return params;
+}
+
+// Checks if a literal holds in this state
+bool TaskState::contains(TaskLiteral* l)
+{
+	int predicate = l->predicate->index;
+	unsigned int n = numFactsOf(predicate), numArgs = arity[predicate];
+	for (unsigned int i = 0; i < n; i++) {
+		const int* args = getArguments(predicate, i);
+		unsigned int arg = 0;
+		while (arg < numArgs && args[arg] == l->arguments[arg]->index) arg++;
+		if (arg == numArgs) return true;
+	}
+	return false;
+}
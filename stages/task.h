@@ -9,6 +9,8 @@
 /* planning task.                               	    */
 /********************************************************/
 
+#include <unordered_map>
+#include <cstdint>
 #include "../preprocess/preprocessedTask.h"
 
 class TaskType {
@@ -59,10 +61,11 @@ public:
 
 class TaskObject {
 public:
+	int index;
 	std::string name;
 	TaskType* type;
 
-	TaskObject(std::string& name, TaskType* t) { this->name = name; this->type = t; }
+	TaskObject(int index, std::string& name, TaskType* t) { this->index = index; this->name = name; this->type = t; }
 };
 
 class TaskLiteral {
@@ -77,18 +80,49 @@ public:
 	bool equals(TaskLiteral* l);
 };
 
+class TaskState {	// Initial state by columns: the facts of each predicate are stored contiguously
+private:
+	std::vector<TaskPredicate*> predicates;
+	std::vector<unsigned int> arity;
+	std::vector<unsigned int> firstArgument;	// Start of the facts of each predicate in the argument array (one more entry at the end)
+	std::vector<unsigned int> nextArgument;		// Used while the facts are added
+	std::vector<int> arguments;					// Object indexes of the fact arguments
+	unsigned int numFacts;
+
+public:
+	TaskState() { numFacts = 0; }
+	void initialize(std::vector<TaskPredicate>& predicates, const std::vector<int>& factPredicates);
+	int* addFact(int predicate);
+	bool contains(TaskLiteral* l);
+	inline unsigned int size() { return numFacts; }
+	inline unsigned int numPredicates() { return (unsigned int)predicates.size(); }
+	inline TaskPredicate* getPredicate(int predicate) { return predicates[predicate]; }
+	inline unsigned int getArity(int predicate) { return arity[predicate]; }
+	inline unsigned int numFactsOf(int predicate) {
+		return (firstArgument[predicate + 1] - firstArgument[predicate]) / arity[predicate];
+	}
+	inline const int* getArguments(int predicate, unsigned int fact) {
+		return arguments.data() + firstArgument[predicate] + fact * arity[predicate];
+	}
+};
+
 class Task {
 private:
 	PreprocessedTask* task;
+	Task* domain;			// Task that stores the types and predicates (this one, unless it is a problem-only task)
 	std::vector<int> newTypeIndex;
 	std::vector<int> oldTypeIndex;
 	std::vector<int> oldPredicateIndex;
+	std::unordered_multimap<uint64_t, int> predicatesByKey;	// Hash of (parsed function, argument types) -> predicate
 	std::vector<int> newObjectIndex;
 
 	void processTypes();
 	void addCompatibleTypes(TaskType* t, std::vector<unsigned int>& parentTypes);
 	void processPredicates();
 	void generatePredicate(Function* f, std::vector<TaskType*>* args);
+	void indexPredicates();
+	template<typename ArgType>
+	TaskPredicate* getPredicate(unsigned int function, unsigned int numArgs, ArgType argType);
 	void processOperators();
 	void generateOperator(Operator* o, std::vector<TaskType*>* parameters);
 	void computeEffects(TaskOperator& to, Operator* o);
@@ -96,8 +130,9 @@ private:
 	TaskPredicate* matchEffect(Literal *l, std::vector<TaskType*>* opParams, Operator* o, std::vector<int>& parameterIndex);
 	void processObjects();
 	void processInitialState();
+	void addInitialFact(int predicate, const unsigned int* args);
 	void processGoal();
-	TaskPredicate* findPredicate(Fact* f);
+	TaskPredicate* findPredicate(unsigned int function, const unsigned int* args, unsigned int numArgs);
 	TaskPredicate* findPredicate(Literal* l);
 
 public:
@@ -105,10 +140,11 @@ public:
 	std::vector<TaskPredicate> predicates;
 	std::vector<TaskOperator> operators;
 	std::vector<TaskObject> objects;
-	std::vector<TaskLiteral> state;
+	TaskState state;
 	std::vector<TaskLiteral> goal;
 
 	Task(PreprocessedTask* pTask);
+	Task(PreprocessedTask* pTask, Task* domainTask);
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
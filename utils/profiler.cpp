@@ -0,0 +1,116 @@
+/********************************************************/
+/* Per-phase profiling: wall time (monotonic clock),    */
+/* peak RSS growth and item counts.                     */
+/********************************************************/
+
+#include "profiler.h"
+#include <iomanip>
+#include <sys/resource.h>
+using namespace std;
+
+bool Profiler::enabled = false;
+vector<Profiler::Phase> Profiler::phases;
+mutex Profiler::lock;
+thread_local int ProfileScope::depth = 0;
+
+// Returns the peak resident set size of the process, in KB
+long Profiler::peakRSS()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return usage.ru_maxrss;
+}
+
+// Registers the start of a phase and returns its index. Phases with the same name are
+// accumulated
+int Profiler::startPhase(const char* name, int depth)
+{
+	lock_guard<mutex> guard(lock);
+	for (int i = 0; i < (int)phases.size(); i++)
+		if (phases[i].name == name)
+			return i;
+	phases.emplace_back();
+	Phase& p = phases.back();
+	p.name = name;
+	p.depth = depth;
+	p.calls = 0;
+	p.time = 0;
+	p.rssDelta = 0;
+	return (int)phases.size() - 1;
+}
+
+// Registers the end of a phase
+void Profiler::endPhase(int phase, double time, long rssDelta, const vector< pair<const char*, long> >& counts)
+{
+	lock_guard<mutex> guard(lock);
+	Phase& p = phases[phase];
+	p.calls++;
+	p.time += time;
+	p.rssDelta += rssDelta;
+	for (const pair<const char*, long>& c : counts) {
+		int i = 0;
+		while (i < (int)p.itemNames.size() && p.itemNames[i] != c.first) i++;
+		if (i == (int)p.itemNames.size()) {
+			p.itemNames.push_back(c.first);
+			p.itemCounts.push_back(0);
+		}
+		p.itemCounts[i] += c.second;
+	}
+}
+
+// Writes a human-readable report
+void Profiler::report(ostream& out)
+{
+	lock_guard<mutex> guard(lock);
+	out << "Phase                                 Calls    Time (ms)  Peak RSS +KB  Items" << endl;
+	for (Phase& p : phases) {
+		string name = string(2 * p.depth, ' ') + p.name;
+		out << left << setw(36) << name << right << setw(7) << p.calls << setw(13) << fixed 
+			<< setprecision(3) << p.time * 1000 << setw(14) << p.rssDelta << " ";
+		for (int i = 0; i < (int)p.itemNames.size(); i++)
+			out << " " << p.itemNames[i] << "=" << p.itemCounts[i];
+		out << endl;
+	}
+}
+
+// Writes the report in JSON format
+void Profiler::toJSON(ostream& out)
+{
+	lock_guard<mutex> guard(lock);
+	out << "{" << endl << "  \"phases\": [" << endl;
+	for (int i = 0; i < (int)phases.size(); i++) {
+		Phase& p = phases[i];
+		out << "    { \"name\": \"" << p.name << "\", \"depth\": " << p.depth << ", \"calls\": " << p.calls
+			<< ", \"timeMs\": " << fixed << setprecision(3) << p.time * 1000 << ", \"peakRssDeltaKB\": " 
+			<< p.rssDelta << ", \"items\": {";
+		for (int j = 0; j < (int)p.itemNames.size(); j++) {
+			if (j > 0) out << ", ";
+			out << "\"" << p.itemNames[j] << "\": " << p.itemCounts[j];
+		}
+		out << "} }";
+		if (i < (int)phases.size() - 1) out << ",";
+		out << endl;
+	}
+	out << "  ]" << endl << "}" << endl;
+}
+
+// Starts measuring a phase
+ProfileScope::ProfileScope(const char* name)
+{
+	if (Profiler::isEnabled()) {
+		phase = Profiler::startPhase(name, depth++);
+		startRSS = Profiler::peakRSS();
+		start = chrono::steady_clock::now();
+	}
+	else phase = -1;
+}
+
+// Records the phase data
+ProfileScope::~ProfileScope()
+{
+	if (phase != -1) {
+		double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		Profiler::endPhase(phase, time, Profiler::peakRSS() - startRSS, counts);
+		depth--;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/********************************************************/
+/* Per-phase profiling: wall time (monotonic clock),    */
+/* peak RSS growth and item counts. Disabled by         */
+/* default; a ProfileScope only records data when the   */
+/* profiler has been enabled.                           */
+/********************************************************/
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <ostream>
+
+class Profiler {
+private:
+	class Phase {
+	public:
+		std::string name;
+		int depth;
+		int calls;
+		double time;				// Seconds
+		long rssDelta;				// Growth of the peak RSS, in KB
+		std::vector<std::string> itemNames;
+		std::vector<long> itemCounts;
+	};
+	static bool enabled;
+	static std::vector<Phase> phases;	// In order of first start
+	static std::mutex lock;
+
+public:
+	static void enable() { enabled = true; }
+	static inline bool isEnabled() { return enabled; }
+	static long peakRSS();
+	static int startPhase(const char* name, int depth);
+	static void endPhase(int phase, double time, long rssDelta, 
+		const std::vector< std::pair<const char*, long> >& counts);
+	static void report(std::ostream& out);
+	static void toJSON(std::ostream& out);
+};
+
+class ProfileScope {
+private:
+	int phase;									// -1 if the profiler is disabled
+	std::chrono::steady_clock::time_point start;
+	long startRSS;
+	std::vector< std::pair<const char*, long> > counts;
+	static thread_local int depth;
+
+public:
+	ProfileScope(const char* name);
+	~ProfileScope();
+	inline void count(const char* item, long value) {
+		if (phase != -1) counts.emplace_back(item, value);
+	}
+};
+
+#endif // !#ifndef PROFILER_H
@@ -0,0 +1,97 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+/********************************************************/
+/* Thread pool for a fixed set of independent jobs.     */
+/* Each worker has its own queue and, once it is empty, */
+/* steals jobs from the queues of the other workers.    */
+/********************************************************/
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+class WorkStealingPool {
+private:
+	struct WorkerQueue {
+		std::mutex lock;
+		std::deque<int> jobs;
+	};
+	std::vector<WorkerQueue*> queues;
+	std::vector<std::thread> threads;
+	std::function<void(int)> job;
+	std::atomic<bool> cancelled;
+
+	// Takes the lowest job of the worker queue or, if it is empty, steals the highest
+	// job of another worker
+	bool nextJob(int worker, int& jobIndex) {
+		int numWorkers = (int)queues.size();
+		{
+			std::lock_guard<std::mutex> guard(queues[worker]->lock);
+			if (!queues[worker]->jobs.empty()) {
+				jobIndex = queues[worker]->jobs.front();
+				queues[worker]->jobs.pop_front();
+				return true;
+			}
+		}
+		for (int i = 1; i < numWorkers; i++) {
+			WorkerQueue* victim = queues[(worker + i) % numWorkers];
+			std::lock_guard<std::mutex> guard(victim->lock);
+			if (!victim->jobs.empty()) {
+				jobIndex = victim->jobs.back();
+				victim->jobs.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Runs jobs until there are no jobs left or the pool is cancelled
+	void work(int worker) {
+		int jobIndex;
+		while (!cancelled && nextJob(worker, jobIndex))
+			job(jobIndex);
+	}
+
+public:
+	WorkStealingPool(int numThreads) {
+		if (numThreads < 1) numThreads = 1;
+		for (int i = 0; i < numThreads; i++)
+			queues.push_back(new WorkerQueue());
+		cancelled = false;
+	}
+
+	~WorkStealingPool() {
+		cancel();
+		wait();
+		for (WorkerQueue* q : queues)
+			delete q;
+	}
+
+	// Runs job(0) ... job(numJobs - 1) in the background. Jobs are initially assigned
+	// in round-robin, so the lowest ones are started first
+	void start(int numJobs, std::function<void(int)> job) {
+		this->job = job;
+		for (int i = 0; i < numJobs; i++)
+			queues[i % queues.size()]->jobs.push_back(i);
+		for (int i = 0; i < (int)queues.size(); i++)
+			threads.emplace_back(&WorkStealingPool::work, this, i);
+	}
+
+	// Discards the jobs that have not been started yet
+	void cancel() {
+		cancelled = true;
+	}
+
+	// Waits until all workers have finished
+	void wait() {
+		for (std::thread& t : threads)
+			t.join();
+		threads.clear();
+	}
+};
+
+#endif // !#ifndef WORK_STEALING_POOL_H